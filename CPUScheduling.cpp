@@ -1,541 +1,473 @@
-#include <queue>
-#include <vector>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Comparison.h"
+#include "scheduler/CostModel.h"
+#include "scheduler/KernelTrace.h"
+#include "scheduler/MultiCore.h"
+#include "scheduler/Process.h"
+#include "scheduler/Schedulers.h"
+#include "scheduler/Simulator.h"
+#include "scheduler/Statistics.h"
+#include "scheduler/Sweep.h"
+#include "scheduler/TraceFile.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+void printResults(const Process& process) {
+    std::cout << "Process P" << process.pid << ":\n";
+    std::cout << "  Waiting Time (Tw): " << process.waitingTime << "\n";
+    std::cout << "  Turnaround Time (Ttr): " << process.turnaroundTime << "\n";
+    std::cout << "  Response Time (Tr): " << process.responseTime << "\n";
+}
 
-struct Process {
-    int pid;
-    std::vector<int> cpuBursts;
-    std::vector<int> ioTimes;
-    int currentBurstIndex = 0;
-    int arrivalTime = 0;
-    int initialArrivalTime = 0; 
-    int waitingTime = 0;
-    int turnaroundTime = 0;
-    int responseTime = -1;
-    bool isCompleted = false;
-
-    int remainingCpuTime = 0;
-    int remainingIoTime = 0;
-
-    int queueLevel = 1;      
-    int timeSliceUsed = 0;   
-
-    Process(int id, std::vector<int> cpu, std::vector<int> io)
-        : pid(id), cpuBursts(cpu), ioTimes(io) {}
-};
-
-
-
-void schedulerFunction(std::vector<Process*>& processes) {
-    int currentTime = 0;
-    int totalCpuTime = 0;          // Total CPU time used
-    int totalSimulationTime = 0;   // Total time from start to completion of all processes
-
-    std::vector<Process*> readyQueue;
-    std::vector<Process*> ioQueue;
-
-    // Initialize all processes in the ready queue
-    for (auto& process : processes) {
-        process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-        readyQueue.push_back(process);
+// Reads the whole of `text` as an integer in [low, high]. Anything else is a
+// usage error, reported against `option`, that ends the program.
+long long parseInteger(const std::string& option, const std::string& text,
+                       long long low, long long high = INT_MAX) {
+    errno = 0;
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno == ERANGE || value < low || value > high) {
+        std::cerr << option << " needs an integer from " << low << " to " << high
+            << ", not \"" << text << "\"" << std::endl;
+        exit(1);
     }
+    return value;
+}
 
-    while (!readyQueue.empty() || !ioQueue.empty()) {
-        // If ready queue is empty, advance time to the next I/O completion
-        if (readyQueue.empty()) {
-            int nextIoCompletionTime = INT_MAX;
-            for (auto& process : ioQueue) {
-                int completionTime = process->arrivalTime + process->remainingIoTime;
-                if (completionTime < nextIoCompletionTime) {
-                    nextIoCompletionTime = completionTime;
-                }
-            }
-            currentTime = nextIoCompletionTime;
-
-            // Move processes that have completed I/O back to the ready queue
-            for (auto it = ioQueue.begin(); it != ioQueue.end();) {
-                Process* process = *it;
-                int completionTime = process->arrivalTime + process->remainingIoTime;
-                if (completionTime <= currentTime) {
-                    process->currentBurstIndex++;
-                    if (process->currentBurstIndex < process->cpuBursts.size()) {
-                        process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-                        process->arrivalTime = currentTime;
-                        readyQueue.push_back(process);
-                        it = ioQueue.erase(it);
-                    }
-                    else {
-                        // Process has completed all CPU bursts
-                        process->isCompleted = true;
-                        process->turnaroundTime = currentTime - process->initialArrivalTime;
-                        it = ioQueue.erase(it);
-                    }
-                }
-                else {
-                    ++it;
-                }
-            }
-
-            continue; // Go back to the beginning of the loop
+// Reads a cost model option into `costs`; false if `option` is not one.
+bool parseCostOption(const std::string& option, const std::string& value, CostModel& costs) {
+    if (option == "--switch-cost") {
+        costs.switchCost = static_cast<int>(parseInteger(option, value, 0));
+    }
+    else if (option == "--cold-cost") {
+        costs.coldCost = static_cast<int>(parseInteger(option, value, 0));
+    }
+    else if (option == "--cold-after") {
+        costs.coldAfter = static_cast<int>(parseInteger(option, value, 0));
+    }
+    else if (option == "--dispatch-cost") {
+        // One cost per queue level, comma-separated
+        costs.dispatchCost.clear();
+        for (size_t start = 0; start <= value.size();) {
+            size_t end = std::min(value.find(',', start), value.size());
+            costs.dispatchCost.push_back(static_cast<int>(parseInteger(option, value.substr(start, end - start), 0)));
+            start = end + 1;
         }
+    }
+    else {
+        return false;
+    }
+    return true;
+}
 
-        // Schedule the next process from the ready queue (FCFS)
-        Process* currentProcess = readyQueue.front();
-        readyQueue.erase(readyQueue.begin());
-
-        // Record response time if not already set
-        if (currentProcess->responseTime == -1) {
-            currentProcess->responseTime = currentTime - currentProcess->initialArrivalTime;
+// Usage:
+//   CPUScheduling                          run the built-in eight-process workload
+//   CPUScheduling <trace>                  stream a text or binary trace file
+//   CPUScheduling --events <log> [trace]   write scheduler events to a binary log instead of stdout
+//   CPUScheduling --boost <n> [trace]      MLFQ moves every process back to level 1 each n time units
+//   CPUScheduling --aging <n> [trace]      MLFQ moves a process up a level after waiting n in one
+//   CPUScheduling --stats <file> [trace]   write latency percentiles and queue series to <file>
+//                                          (CSV if it ends in .csv, else JSON) instead of per-process results
+//   CPUScheduling --switch-cost <n> [trace]     charge n time units to switch the CPU to another process
+//   CPUScheduling --cold-cost <n> [trace]       charge n more when the process's cache is cold: it never
+//                                          ran, migrated, or has been off the CPU for --cold-after <n>
+//   CPUScheduling --dispatch-cost <a,b,..> [trace]  charge a per dispatch at queue level 1, b at level 2...
+//                                          Cost options also apply to --compare and --cores; the report
+//                                          then splits CPU time into useful work, overhead and idle
+//   CPUScheduling --checkpoint <t> <file> [trace]  save a snapshot of the run once it reaches time t
+//   CPUScheduling --resume <file> [trace]  continue a run from a snapshot, under any policy
+//   CPUScheduling --print-events <log>     print a binary event log as text
+//   CPUScheduling --convert <in> <out>     re-encode a trace (text if <out> ends in .txt)
+//   CPUScheduling --import <capture> <out> [ns]  turn a perf sched / ftrace text dump into a
+//                                          trace, one time unit per ns nanoseconds (default 1000)
+//   CPUScheduling --compare [trace]        run every policy in parallel and tabulate them
+//   CPUScheduling --cores <n> [options]    simulate n CPUs with per-core queues and work stealing
+//       --policy <p>       fcfs, sjf, srtf, rr, mlfq, priority or cfs (default fcfs)
+//       --boost, --aging   MLFQ starvation guards, as above
+//       --domain <n>       cores per balancing domain (default 4)
+//       --interval <n>     time between balancing passes across domains (default 20)
+//       --trace <path>     workload to run instead of a synthetic one
+//       --processes <n>    processes in the synthetic workload (default 1000)
+//       --seed <n>         seed for the synthetic workload
+//       --switch-cost, --cold-cost, --cold-after, --dispatch-cost as above
+//   CPUScheduling --sweep [options]        search MLFQ quanta for the response/throughput Pareto front
+//       --random <n>       sample n random configurations instead of the grid
+//       --workloads <n>    synthetic workloads per configuration (default 16)
+//       --processes <n>    processes per workload (default 64)
+//       --seed <n>         seed for the workloads and random configurations
+int runSweep(int argc, char* argv[]) {
+    int randomCount = 0;
+    int workloadCount = 16;
+    WorkloadSpec spec;
+    std::uint64_t seed = 1;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--random") {
+            randomCount = static_cast<int>(parseInteger(option, value, 0));
         }
-
-        // Update waiting time
-        currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
-
-        // Run the CPU burst
-        std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-            << " is running CPU burst of " << currentProcess->remainingCpuTime << " units.\n";
-        currentTime += currentProcess->remainingCpuTime;
-        totalCpuTime += currentProcess->remainingCpuTime; // Accumulate CPU time
-
-        // Check if there is a corresponding I/O burst
-        if (currentProcess->currentBurstIndex < currentProcess->ioTimes.size()) {
-            // Set remaining I/O time
-            currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
-            currentProcess->arrivalTime = currentTime;
-            ioQueue.push_back(currentProcess);
-
-            std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                << " is performing I/O for " << currentProcess->remainingIoTime << " units.\n";
+        else if (option == "--workloads") {
+            workloadCount = static_cast<int>(parseInteger(option, value, 0));
         }
-        else {
-            // Process has completed all CPU bursts
-            currentProcess->isCompleted = true;
-            currentProcess->turnaroundTime = currentTime - currentProcess->initialArrivalTime;
-
-            std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                << " has completed execution.\n";
+        else if (option == "--processes") {
+            spec.processes = static_cast<int>(parseInteger(option, value, 0));
         }
-
-        // Move processes that have completed I/O back to the ready queue
-        for (auto it = ioQueue.begin(); it != ioQueue.end();) {
-            Process* process = *it;
-            int completionTime = process->arrivalTime + process->remainingIoTime;
-            if (completionTime <= currentTime) {
-                process->currentBurstIndex++;
-                if (process->currentBurstIndex < process->cpuBursts.size()) {
-                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-                    process->arrivalTime = completionTime;
-                    readyQueue.push_back(process);
-                    it = ioQueue.erase(it);
-                }
-                else {
-                    // Process has completed all CPU bursts
-                    process->isCompleted = true;
-                    process->turnaroundTime = completionTime - process->initialArrivalTime;
-                    it = ioQueue.erase(it);
-                }
-            }
-            else {
-                ++it;
-            }
+        else if (option == "--seed") {
+            seed = static_cast<std::uint64_t>(parseInteger(option, value, 0, LLONG_MAX));
+        }
+        else {
+            std::cerr << "Unknown sweep option " << option << std::endl;
+            return 1;
         }
     }
 
-    totalSimulationTime = currentTime;
-
-    // Calculate CPU utilization
-    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
-
-    // Output CPU utilization
-    std::cout << "\nCPU Utilization: " << cpuUtilization << "%\n";
+    std::vector<MlfqConfig> configs = randomCount > 0
+        ? randomConfigs(randomCount, 6, 50, seed)
+        : gridConfigs({ 2, 3, 4, 5 }, { 1, 2, 4, 8, 16 }, { 1, 2, 3, 4 });
+    std::vector<std::vector<Process>> workloads;
+    for (int w = 0; w < workloadCount; ++w) {
+        workloads.push_back(generateWorkload(spec, seed * 1000003 + w));
+    }
 
+    ThreadPool pool;
+    std::vector<SweepPoint> points = runSweep(configs, workloads, pool);
+    markParetoFront(points);
+    std::cout << configs.size() << " configurations x " << workloads.size() << " workloads of "
+        << spec.processes << " processes on " << pool.size() << " threads\n\n";
+    printParetoFront(points, std::cout);
+    return 0;
 }
 
-void SJFschedulerFunction(std::vector<Process*>& processes) {
-    int currentTime = 0;
-    int totalCpuTime = 0;
-    int totalSimulationTime = 0;
-
-    std::vector<Process*> readyQueue;
-    std::vector<Process*> ioQueue;
-
-    // Initialize all processes in the ready queue
-    for (auto& process : processes) {
-        process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-        readyQueue.push_back(process);
+int runMultiCore(int argc, char* argv[]) {
+    MultiCoreConfig config;
+    config.cores = static_cast<int>(parseInteger("--cores", argv[2], 1));
+    std::string policy = "fcfs";
+    MlfqConfig mlfqConfig;
+    std::string tracePath;
+    WorkloadSpec spec;
+    spec.processes = 1000;
+    std::uint64_t seed = 1;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--policy" && (value == "fcfs" || value == "sjf" || value == "srtf" || value == "rr"
+                                     || value == "mlfq" || value == "priority" || value == "cfs")) {
+            policy = value;
+        }
+        else if (option == "--boost") {
+            mlfqConfig.boostPeriod = static_cast<int>(parseInteger(option, value, 0));
+        }
+        else if (option == "--aging") {
+            mlfqConfig.agingThreshold = static_cast<int>(parseInteger(option, value, 0));
+        }
+        else if (option == "--domain") {
+            config.coresPerDomain = static_cast<int>(parseInteger(option, value, 1));
+        }
+        else if (option == "--interval") {
+            config.rebalanceInterval = static_cast<int>(parseInteger(option, value, 1));
+        }
+        else if (option == "--trace") {
+            tracePath = value;
+        }
+        else if (option == "--processes") {
+            spec.processes = static_cast<int>(parseInteger(option, value, 0));
+        }
+        else if (option == "--seed") {
+            seed = static_cast<std::uint64_t>(parseInteger(option, value, 0, LLONG_MAX));
+        }
+        else if (parseCostOption(option, value, config.costs)) {
+        }
+        else {
+            std::cerr << "Unknown multi-core option " << option << " " << value << std::endl;
+            return 1;
+        }
     }
 
-    while (!readyQueue.empty() || !ioQueue.empty()) {
-        // Move processes that have completed I/O back to the ready queue
-        for (auto it = ioQueue.begin(); it != ioQueue.end();) {
-            Process* process = *it;
-            int ioCompletionTime = process->arrivalTime + process->remainingIoTime;
-            if (ioCompletionTime <= currentTime) {
-                // I/O is complete
-                process->currentBurstIndex++;
-                if (process->currentBurstIndex < process->cpuBursts.size()) {
-                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-                    process->arrivalTime = ioCompletionTime;
-                    readyQueue.push_back(process);
-                    it = ioQueue.erase(it);
-                }
-                else {
-                    // Process has completed all CPU bursts
-                    process->isCompleted = true;
-                    process->turnaroundTime = ioCompletionTime - process->arrivalTime + process->waitingTime;
-                    it = ioQueue.erase(it);
-                }
-            }
-            else {
-                ++it;
-            }
+    try {
+        WorkloadFactory workload = tracePath.empty() ? cloneWorkload(generateWorkload(spec, seed))
+                                                     : traceWorkload(tracePath);
+        std::unique_ptr<ArrivalSource> source = workload();
+        ComparisonRow totals;
+        MetricsArrivalSource arrivals(*source, totals);
+        ThreadPool pool;
+        MultiCoreResult result;
+        if (policy == "sjf") {
+            result = multiCoreScheduler(arrivals, config, SjfPolicy(), pool);
         }
-
-        // If ready queue is empty, advance time to the next I/O completion
-        if (readyQueue.empty()) {
-            // Find the earliest I/O completion time
-            int nextIoCompletionTime = std::numeric_limits<int>::max();
-            for (auto& process : ioQueue) {
-                int completionTime = process->arrivalTime + process->remainingIoTime;
-                if (completionTime < nextIoCompletionTime) {
-                    nextIoCompletionTime = completionTime;
-                }
-            }
-            // Advance currentTime
-            currentTime = nextIoCompletionTime;
-            continue;
+        else if (policy == "srtf") {
+            result = multiCoreScheduler(arrivals, config, SrtfPolicy(), pool);
         }
-
-        // Select the process with the shortest next CPU burst
-        auto shortestProcessIt = std::min_element(readyQueue.begin(), readyQueue.end(),
-            [](Process* a, Process* b) {
-                int burstA = a->remainingCpuTime;
-                int burstB = b->remainingCpuTime;
-                if (burstA != burstB) {
-                    return burstA < burstB;
-                }
-                else {
-                    // Tie-breaker: select process with lower PID
-                    return a->pid < b->pid;
-                }
-            });
-        Process* currentProcess = *shortestProcessIt;
-        readyQueue.erase(shortestProcessIt);
-
-        // Record response time if not already set
-        if (currentProcess->responseTime == -1) {
-            currentProcess->responseTime = currentTime - currentProcess->arrivalTime;
+        else if (policy == "rr") {
+            result = multiCoreScheduler(arrivals, config, RoundRobinPolicy(), pool);
         }
-
-        // Update waiting time
-        currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
-
-        // Run the CPU burst
-        std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-            << " is running CPU burst of " << currentProcess->remainingCpuTime << " units.\n";
-        currentTime += currentProcess->remainingCpuTime;
-        totalCpuTime += currentProcess->remainingCpuTime;
-
-        // Check if there is a corresponding I/O burst
-        if (currentProcess->currentBurstIndex < currentProcess->ioTimes.size()) {
-            // Set remaining I/O time
-            currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
-            currentProcess->arrivalTime = currentTime;
-            ioQueue.push_back(currentProcess);
-
-            std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                << " is performing I/O for " << currentProcess->remainingIoTime << " units.\n";
+        else if (policy == "mlfq") {
+            validateMlfqConfig(mlfqConfig);
+            result = multiCoreScheduler(arrivals, config, MlfqPolicy(mlfqConfig), pool);
+        }
+        else if (policy == "priority") {
+            result = multiCoreScheduler(arrivals, config, PriorityPolicy(), pool);
+        }
+        else if (policy == "cfs") {
+            result = multiCoreScheduler(arrivals, config, CfsPolicy(), pool);
         }
         else {
-            // Process has completed all CPU bursts
-            currentProcess->isCompleted = true;
-            currentProcess->turnaroundTime = currentTime - currentProcess->arrivalTime + currentProcess->waitingTime;
-
-            std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                << " has completed execution.\n";
+            result = multiCoreScheduler(arrivals, config, FcfsPolicy(), pool);
         }
+        printMultiCore(result, totals, std::cout);
     }
-
-    totalSimulationTime = currentTime;
-
-    // Calculate CPU utilization
-    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
-
-    // Output CPU utilization
-    std::cout << "\nCPU Utilization: " << cpuUtilization << "%\n";
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
-void mlfqScheduler(std::vector<Process*>& processes) {
-    int currentTime = 0;
-    int totalCpuTime = 0;
-    int totalSimulationTime = 0;
-
-    // Ready queues for each level
-    std::queue<Process*> queue1; // Highest priority, Tq = 5
-    std::queue<Process*> queue2; // Middle priority, Tq = 10
-    std::queue<Process*> queue3; // Lowest priority, FCFS
-
-    std::vector<Process*> ioQueue; // Processes performing I/O
-
-    // Initialize processes
-    for (auto& process : processes) {
-        process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-        process->arrivalTime = 0; // All processes arrive at time 0
-        process->queueLevel = 1;  // Start at highest priority queue
-        queue1.push(process);
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && std::string(argv[1]) == "--cores") {
+        return runMultiCore(argc, argv);
     }
 
-    Process* currentProcess = nullptr;
-    int timeQuantum = 0;
-    int timeSlice = 0; // Time used in the current time quantum
+    if (argc >= 2 && std::string(argv[1]) == "--sweep") {
+        return runSweep(argc, argv);
+    }
 
-    while (!queue1.empty() || !queue2.empty() || !queue3.empty() || !ioQueue.empty() || currentProcess != nullptr) {
-        // Move processes that have completed I/O back to the appropriate queue
-        for (auto it = ioQueue.begin(); it != ioQueue.end();) {
-            Process* process = *it;
-            int ioCompletionTime = process->arrivalTime + process->remainingIoTime;
-            if (ioCompletionTime <= currentTime) {
-                // I/O is complete
-                process->currentBurstIndex++;
-                if (process->currentBurstIndex < process->cpuBursts.size()) {
-                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-                    process->arrivalTime = ioCompletionTime;
-                    process->timeSliceUsed = 0; // Reset time slice used
-                    // Place the process back into its current queue level
-                    if (process->queueLevel == 1) {
-                        queue1.push(process);
-                    }
-                    else if (process->queueLevel == 2) {
-                        queue2.push(process);
-                    }
-                    else {
-                        queue3.push(process);
-                    }
-                    it = ioQueue.erase(it);
-                }
-                else {
-                    // Process has completed all CPU bursts
-                    process->isCompleted = true;
-                    process->turnaroundTime = ioCompletionTime - process->arrivalTime + process->waitingTime;
-                    it = ioQueue.erase(it);
-                }
-            }
-            else {
-                ++it;
-            }
+    if (argc == 3 && std::string(argv[1]) == "--print-events") {
+        try {
+            printEventLog(argv[2], std::cout);
         }
-
-        // Check for preemption
-        bool preempt = false;
-        if (currentProcess != nullptr && currentProcess->queueLevel > 1) {
-            // Check if a higher priority process is ready
-            if (!queue1.empty()) {
-                preempt = true;
-            }
+        catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
         }
+        return 0;
+    }
 
-        // If preemption occurs or no process is running, select the next process
-        if (currentProcess == nullptr || preempt) {
-            if (preempt) {
-                // Preempt the current process and place it back into its queue
-                std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                    << " is preempted and moved back to queue level " << currentProcess->queueLevel << ".\n";
-                if (currentProcess->queueLevel == 2) {
-                    queue2.push(currentProcess);
-                }
-                else if (currentProcess->queueLevel == 3) {
-                    queue3.push(currentProcess);
-                }
-                currentProcess = nullptr;
-            }
+    // Scheduler events go to stdout as they happen unless a binary log is requested
+    std::unique_ptr<TraceSink> eventLog;
+    if (argc >= 3 && std::string(argv[1]) == "--events") {
+        try {
+            eventLog.reset(new BinaryTraceSink(argv[2]));
+        }
+        catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    TraceSink& events = eventLog ? *eventLog : standardOutputTrace();
+
+    // Starvation guards for MLFQ, dispatch costs, the statistics file and
+    // snapshots; these come after --events when both are given
+    MlfqConfig mlfqConfig;
+    CostModel costs;
+    std::string statisticsPath;
+    int checkpointTime = -1;
+    std::string checkpointPath;
+    std::string resumePath;
+    for (;;) {
+        std::string option = argc >= 3 ? argv[1] : "";
+        int consumed = 2;
+        if (option == "--boost") {
+            mlfqConfig.boostPeriod = static_cast<int>(parseInteger(option, argv[2], 0));
+        }
+        else if (option == "--aging") {
+            mlfqConfig.agingThreshold = static_cast<int>(parseInteger(option, argv[2], 0));
+        }
+        else if (option == "--stats") {
+            statisticsPath = argv[2];
+        }
+        else if (option == "--resume") {
+            resumePath = argv[2];
+        }
+        else if (option == "--checkpoint" && argc >= 4) {
+            checkpointTime = static_cast<int>(parseInteger(option, argv[2], 0));
+            checkpointPath = argv[3];
+            consumed = 3;
+        }
+        else if (option.empty() || !parseCostOption(option, argv[2], costs)) {
+            break;
+        }
+        argv[consumed] = argv[0];
+        argv += consumed;
+        argc -= consumed;
+    }
+    if (!costs.valid()) {
+        std::cerr << "Switch, cold-cache and dispatch costs must not be negative" << std::endl;
+        exit(1);
+    }
 
-            // Select the next process from the highest priority non-empty queue
-            if (!queue1.empty()) {
-                currentProcess = queue1.front();
-                queue1.pop();
-                timeQuantum = 5;
-            }
-            else if (!queue2.empty()) {
-                currentProcess = queue2.front();
-                queue2.pop();
-                timeQuantum = 10;
+    if ((argc == 4 || argc == 5) && std::string(argv[1]) == "--import") {
+        std::string output = argv[3];
+        bool text = output.size() >= 4 && output.compare(output.size() - 4, 4, ".txt") == 0;
+        KernelTraceOptions options;
+        if (argc == 5) {
+            char* end = nullptr;
+            options.tickNanoseconds = std::strtod(argv[4], &end);
+            if (end == argv[4] || *end != '\0' || !(options.tickNanoseconds > 0.0)) {
+                std::cerr << "--import needs a positive number of nanoseconds per time unit, not \"" << argv[4] << "\"" << std::endl;
+                exit(1);
             }
-            else if (!queue3.empty()) {
-                currentProcess = queue3.front();
-                queue3.pop();
-                timeQuantum = currentProcess->remainingCpuTime; // For FCFS, run until completion
-            }
-            else {
-                // No process is ready; advance time to next I/O completion
-                int nextIoCompletionTime = INT_MAX;
-                for (auto& process : ioQueue) {
-                    int completionTime = process->arrivalTime + process->remainingIoTime;
-                    if (completionTime < nextIoCompletionTime) {
-                        nextIoCompletionTime = completionTime;
-                    }
-                }
-                currentTime = nextIoCompletionTime;
-                continue;
-            }
-
-            // Record response time if not already set
-            if (currentProcess->responseTime == -1) {
-                currentProcess->responseTime = currentTime - currentProcess->arrivalTime;
+        }
+        try {
+            KernelTraceSummary summary = importKernelTrace(argv[2], output, text ? TraceFormat::Text : TraceFormat::Binary, options);
+            std::cout << "Imported " << summary.processes << " processes from " << summary.events
+                << " scheduler events in " << summary.lines << " lines";
+            if (summary.droppedTasks > 0) {
+                std::cout << " (" << summary.droppedTasks << " tasks never ran)";
             }
-
-            // Update waiting time
-            currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
-            currentProcess->timeSliceUsed = 0; // Reset time slice used
+            std::cout << "\n";
+        }
+        catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
         }
+        return 0;
+    }
 
-        // Determine execution time for the current time slice
-        int executionTime = std::min({ currentProcess->remainingCpuTime, timeQuantum - currentProcess->timeSliceUsed });
+    if (argc == 4 && std::string(argv[1]) == "--convert") {
+        std::string output = argv[3];
+        bool text = output.size() >= 4 && output.compare(output.size() - 4, 4, ".txt") == 0;
+        try {
+            convertTrace(argv[2], output, text ? TraceFormat::Text : TraceFormat::Binary);
+        }
+        catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
+        }
+        return 0;
+    }
 
-        // Simulate execution
-        std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-            << " is running for " << executionTime << " units (Queue Level " << currentProcess->queueLevel << ").\n";
+    // Create processes and initialize them with data
+    std::vector<Process> builtIn = builtInWorkload();
+    std::vector<Process*> processes;
+    for (Process& process : builtIn) {
+        processes.push_back(&process);
+    }
 
-        currentTime += executionTime;
-        totalCpuTime += executionTime;
-        currentProcess->remainingCpuTime -= executionTime;
-        currentProcess->timeSliceUsed += executionTime;
+    // Batch mode: every policy gets its own copy of the workload and runs on the pool
+    if (argc >= 2 && std::string(argv[1]) == "--compare") {
+        WorkloadFactory workload = argc >= 3 ? traceWorkload(argv[2]) : cloneWorkload(builtIn);
+        ThreadPool pool;
+        printComparison(comparePolicies(standardPolicies(costs), workload, pool), std::cout);
+        return 0;
+    }
 
-        // Move processes that have completed I/O back to the appropriate queue during execution
-        for (auto it = ioQueue.begin(); it != ioQueue.end();) {
-            Process* process = *it;
-            int ioCompletionTime = process->arrivalTime + process->remainingIoTime;
-            if (ioCompletionTime <= currentTime) {
-                // I/O is complete
-                process->currentBurstIndex++;
-                if (process->currentBurstIndex < process->cpuBursts.size()) {
-                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
-                    process->arrivalTime = ioCompletionTime;
-                    process->timeSliceUsed = 0; // Reset time slice used
-                    if (process->queueLevel == 1) {
-                        queue1.push(process);
-                    }
-                    else if (process->queueLevel == 2) {
-                        queue2.push(process);
-                    }
-                    else {
-                        queue3.push(process);
-                    }
-                    it = ioQueue.erase(it);
-                }
-                else {
-                    // Process has completed all CPU bursts
-                    process->isCompleted = true;
-                    process->turnaroundTime = ioCompletionTime - process->arrivalTime + process->waitingTime;
-                    it = ioQueue.erase(it);
+    VectorArrivalSource fixedWorkload(processes);
+    bool perProcess = statisticsPath.empty();
+
+    // A trace file replaces the built-in workload. Its processes are admitted as
+    // simulated time reaches their arrival and reported as soon as they finish.
+    std::unique_ptr<TraceReader> trace;
+    if (argc == 2) {
+        try {
+            trace.reset(new TraceReader(argv[1], [perProcess](const Process& process) {
+                if (perProcess) {
+                    printResults(process);
                 }
-            }
-            else {
-                ++it;
-            }
+            }));
         }
-
-        // Check if the current process has completed its CPU burst
-        if (currentProcess->remainingCpuTime == 0) {
-            // CPU burst is complete
-            std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                << " has completed its CPU burst.\n";
-            if (currentProcess->currentBurstIndex < currentProcess->ioTimes.size()) {
-                // Process has an I/O burst
-                currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
-                currentProcess->arrivalTime = currentTime;
-                ioQueue.push_back(currentProcess);
-
-                std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                    << " is performing I/O for " << currentProcess->remainingIoTime << " units.\n";
-            }
-            else {
-                // Process has completed all CPU bursts
-                currentProcess->isCompleted = true;
-                currentProcess->turnaroundTime = currentTime - currentProcess->initialArrivalTime;
-
-                std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                    << " has completed execution.\n";
-            }
-            currentProcess = nullptr; // CPU is now idle
-        }
-        else if (currentProcess->timeSliceUsed == timeQuantum) {
-            // Time quantum used up
-            if (currentProcess->queueLevel < 3) {
-                // Demote to next lower queue
-                currentProcess->queueLevel++;
-                std::cout << "[Time " << currentTime << "] Process P" << currentProcess->pid
-                    << " is demoted to queue level " << currentProcess->queueLevel << ".\n";
-            }
-            // Reset time slice used
-            currentProcess->timeSliceUsed = 0;
-            currentProcess->arrivalTime = currentTime; // Update arrival time
-            // Place the process back into the appropriate queue
-            if (currentProcess->queueLevel == 2) {
-                queue2.push(currentProcess);
-            }
-            else if (currentProcess->queueLevel == 3) {
-                queue3.push(currentProcess);
-            }
-            currentProcess = nullptr; // CPU is now idle
+        catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            exit(1);
         }
-        // Else, continue running current process in the next iteration
     }
-
-    totalSimulationTime = currentTime;
-
-    // Calculate CPU utilization
-    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
-
-    // Output CPU utilization
-    std::cout << "\nCPU Utilization: " << cpuUtilization << "%\n";
-}
-
-int main() {
-    // Create processes and initialize them with data
-    Process p1(1, std::vector<int>{5, 3, 5, 4, 6, 4, 3, 4}, std::vector<int>{27, 31, 43, 18, 22, 26, 24});
-    Process p2(2, std::vector<int>{4, 5, 7, 12, 9, 4, 9, 7, 8}, std::vector<int>{48, 44, 42, 37, 76, 41, 31, 43});
-    Process p3(3, std::vector<int>{8, 12, 18, 14, 4, 15, 14, 5, 6}, std::vector<int>{33, 41, 65, 21, 61, 18, 26, 31});
-    Process p4(4, std::vector<int>{3, 4, 5, 3, 4, 5, 6, 5, 3}, std::vector<int>{35, 41, 45, 51, 61, 54, 82, 77});
-    Process p5(5, std::vector<int>{16, 17, 5, 16, 7, 13, 11, 6, 3, 4}, std::vector<int>{24, 21, 36, 26, 31, 28, 21, 13, 11});
-    Process p6(6, std::vector<int>{11, 4, 5, 6, 7, 9, 12, 15, 8}, std::vector<int>{22, 8, 10, 12, 14, 18, 24, 30});
-    Process p7(7, std::vector<int>{14, 17, 11, 15, 4, 7, 16, 10}, std::vector<int>{46, 41, 42, 21, 32, 19, 33});
-    Process p8(8, std::vector<int>{4, 5, 6, 14, 16, 6}, std::vector<int>{14, 33, 51, 73, 87});
-    
-    std::vector<Process*> processes = {&p1, &p2, &p3, &p4, &p5, &p6, &p7, &p8};
+    ArrivalSource& arrivals = trace ? static_cast<ArrivalSource&>(*trace) : fixedWorkload;
 
     int input = 0;
-    std::cout << "Enter an input 1-3. 1.FCFS 2. SJF 3. MLFQ." << std::endl;
+    std::cout << "Enter an input 1-4. 1.FCFS 2. SJF 3. MLFQ 4. SRTF." << std::endl;
     std::cin >> input;
     
     //Function to make the user choose which
-    switch (input) {
-        case 3:
-            mlfqScheduler(processes);
-            std::cout << "MLFQ Algorithim" << std::endl;
-            break;
-        case 2:
-            SJFschedulerFunction(processes);
-            std::cout << "SJF Algorithimn" << std::endl;
-            break;
-        case 1:
-            schedulerFunction(processes);
-            std::cout << "FCFS Algorithimn" << std::endl;
-            break;
-        default:
-            std::cout << "Incorrect input." << std::endl;
-            exit(1);
-    }
+    std::unique_ptr<Simulator> simulator;
+    const char* algorithm = nullptr;
+    try {
+        switch (input) {
+            case 4:
+                simulator.reset(new Simulator(SrtfPolicy(), arrivals, events));
+                algorithm = "SRTF Algorithm";
+                break;
+            case 3:
+                validateMlfqConfig(mlfqConfig);
+                simulator.reset(new Simulator(MlfqPolicy(mlfqConfig), arrivals, events));
+                algorithm = "MLFQ Algorithim";
+                break;
+            case 2:
+                simulator.reset(new Simulator(SjfPolicy(), arrivals, events));
+                algorithm = "SJF Algorithimn";
+                break;
+            case 1:
+                simulator.reset(new Simulator(FcfsPolicy(), arrivals, events));
+                algorithm = "FCFS Algorithimn";
+                break;
+            default:
+                std::cout << "Incorrect input." << std::endl;
+                exit(1);
+        }
 
+        simulator->setCostModel(costs);
+        if (!resumePath.empty()) {
+            simulator->restore(resumePath);
+        }
+        bool checkpointDue = !checkpointPath.empty();
+        while (simulator->step()) {
+            if (checkpointDue && simulator->now() >= checkpointTime) {
+                simulator->checkpoint(checkpointPath);
+                checkpointDue = false;
+            }
+        }
+        if (checkpointDue) {
+            std::cerr << "The run ended at " << simulator->now() << ", before the checkpoint time" << std::endl;
+        }
+        events.flush();
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        exit(1);
+    }
+    std::cout << algorithm << std::endl;
+    const SimulationStatistics& statistics = simulator->statistics();
 
     // Output results
-    for (const auto& process : processes) {
-        std::cout << "Process P" << process->pid << ":\n";
-        std::cout << "  Waiting Time (Tw): " << process->waitingTime << "\n";
-        std::cout << "  Turnaround Time (Ttr): " << process->turnaroundTime << "\n";
-        std::cout << "  Response Time (Tr): " << process->responseTime << "\n";
+    if (!trace && perProcess) {
+        for (const auto& process : processes) {
+            printResults(*process);
+        }
+    }
+    std::cout << "Max Wait: " << statistics.longestWait().max() << "\n";
+    std::cout << "p99 Wait: " << statistics.longestWait().percentile(99) << "\n";
+    if (!costs.free()) {
+        SchedulerResult result = simulator->result();
+        printTimeBreakdown(result.totalCpuTime, result.overheadTime, result.totalSimulationTime, std::cout);
+    }
+
+    if (!perProcess) {
+        std::ofstream out(statisticsPath);
+        if (!out) {
+            std::cerr << "Cannot write " << statisticsPath << std::endl;
+            exit(1);
+        }
+        bool csv = statisticsPath.size() >= 4 && statisticsPath.compare(statisticsPath.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            statistics.writeCsv(out);
+        }
+        else {
+            statistics.writeJson(out);
+        }
     }
 
 
     return 0;
-} 
\ No newline at end of file
+} 
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Counts heap allocations in the steady state of a simulation. Once a run has
+// warmed up over the first half of its workload, admitting, queueing,
+// dispatching and retiring processes should never reach the allocator: the
+// queues have grown to their peak and processes are recycled by the arrival
+// source's ProcessPool. Runs every policy, with statistics collection, over a
+// generated workload and over text and binary traces of it, and exits with
+// status 1 if any run allocates after its warm-up.
+//
+//   g++ -std=c++17 -O2 -I. bench/AllocationBench.cpp -o allocation_bench
+//   ./allocation_bench [processCount] [seed]
+//
+// Arrival rates are set for 80% offered CPU load, so queue lengths stay bounded.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Engine.h"
+#include "scheduler/Policies.h"
+#include "scheduler/Statistics.h"
+#include "scheduler/TraceFile.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Every allocation in the benchmark goes through here.
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    if (void* memory = std::malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+struct Run {
+    size_t warmUpAllocations = 0;
+    size_t steadyAllocations = 0;
+    long long steadySteps = 0;
+};
+
+// Steps the engine to `warmUntil`, then counts the allocations of the rest of the run.
+template <typename Policy>
+Run measure(ArrivalSource& arrivals, Policy policy, int warmUntil) {
+    NullTraceSink sink;
+    SimulationStatistics statistics;
+    size_t before = allocationCount;
+    Engine<Policy, SimulationStatistics&> engine(arrivals, std::move(policy), sink, statistics);
+    while (engine.now() < warmUntil && engine.step()) {
+    }
+    Run run;
+    run.warmUpAllocations = allocationCount - before;
+    before = allocationCount;
+    while (engine.step()) {
+        run.steadySteps++;
+    }
+    run.steadyAllocations = allocationCount - before;
+    return run;
+}
+
+struct Policy {
+    const char* name;
+    std::function<Run(ArrivalSource&, int)> run;
+};
+
+std::vector<Policy> policies() {
+    return {
+        { "FCFS", [](ArrivalSource& a, int w) { return measure(a, FcfsPolicy(), w); } },
+        { "SJF", [](ArrivalSource& a, int w) { return measure(a, SjfPolicy(), w); } },
+        { "SRTF", [](ArrivalSource& a, int w) { return measure(a, SrtfPolicy(), w); } },
+        { "RR", [](ArrivalSource& a, int w) { return measure(a, RoundRobinPolicy(), w); } },
+        { "MLFQ", [](ArrivalSource& a, int w) { return measure(a, MlfqPolicy(MlfqConfig()), w); } },
+        { "Priority", [](ArrivalSource& a, int w) { return measure(a, PriorityPolicy(), w); } },
+        { "Lottery", [](ArrivalSource& a, int w) { return measure(a, LotteryPolicy(), w); } },
+        { "CFS", [](ArrivalSource& a, int w) { return measure(a, CfsPolicy(), w); } },
+    };
+}
+
+void writeTextTrace(const std::string& path, const WorkloadSpec& spec, std::uint64_t seed) {
+    std::ofstream output(path);
+    for (const Process& process : generateWorkload(spec, seed)) {
+        output << process.pid << ' ' << process.initialArrivalTime;
+        for (size_t i = 0; i < process.cpuBursts.size(); ++i) {
+            output << ' ' << process.cpuBursts[i];
+            if (i < process.ioTimes.size()) {
+                output << ' ' << process.ioTimes[i];
+            }
+        }
+        output << '\n';
+    }
+    if (!output) {
+        std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+        std::exit(1);
+    }
+}
+
+int main(int argc, char** argv) {
+    WorkloadSpec spec;
+    spec.processes = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::uint64_t seed = argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 1;
+    spec.meanInterarrival = meanCpuDemand(spec) / 0.8;
+    int warmUntil = static_cast<int>(spec.processes / 2 * spec.meanInterarrival);
+
+    const std::string textTrace = "allocation_bench.trace.txt";
+    const std::string binaryTrace = "allocation_bench.trace.bin";
+    writeTextTrace(textTrace, spec, seed);
+    convertTrace(textTrace, binaryTrace, TraceFormat::Binary);
+
+    bool clean = true;
+    std::printf("%-20s %18s %18s %14s\n", "Run", "Warm-up allocs", "Steady allocs", "Steady steps");
+    for (const char* source : { "generated", "text", "binary" }) {
+        for (const Policy& policy : policies()) {
+            Run run;
+            if (std::string(source) == "generated") {
+                GeneratedArrivalSource arrivals(spec, seed);
+                run = policy.run(arrivals, warmUntil);
+            }
+            else {
+                TraceReader arrivals(std::string(source) == "text" ? textTrace : binaryTrace);
+                run = policy.run(arrivals, warmUntil);
+            }
+            std::string name = std::string(policy.name) + "/" + source;
+            std::printf("%-20s %18zu %18zu %14lld\n", name.c_str(), run.warmUpAllocations, run.steadyAllocations,
+                run.steadySteps);
+            clean = clean && run.steadyAllocations == 0;
+        }
+    }
+    std::remove(textTrace.c_str());
+    std::remove(binaryTrace.c_str());
+
+    if (!clean) {
+        std::printf("FAILED: the steady state allocated\n");
+        return 1;
+    }
+    std::printf("No allocations in the steady state\n");
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Times the lockstep batch kernel against running the engine once per
+// workload, on thousands of workloads of 8 to 16 processes like the one in
+// main(), and checks that every result is bit-identical, FCFS against
+// schedulerFunction itself. Exits with status 1 on any difference.
+//
+//   g++ -std=c++17 -O2 -march=native -I. bench/BatchBench.cpp -o batch_bench
+//   ./batch_bench [workloads] [repetitions] [seed]
+//
+// The lane count follows the target: 16 with AVX-512, 8 with AVX2 and 4 with
+// SSE2 only, so build with -march=native (or at least -mavx2).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/BatchScheduler.h"
+#include "scheduler/Engine.h"
+#include "scheduler/Policies.h"
+#include "scheduler/Process.h"
+#include "scheduler/Schedulers.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+// Workloads of 8 to 16 processes; every other one arrives all at once as in main().
+std::vector<std::vector<Process>> makeWorkloads(int count, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<Process>> workloads;
+    workloads.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        WorkloadSpec spec;
+        spec.processes = std::uniform_int_distribution<int>(8, 16)(rng);
+        spec.maxBursts = 9;
+        spec.meanCpuBurst = 8.0;
+        spec.meanIoTime = 35.0;
+        spec.meanInterarrival = i % 2 == 0 ? 0.0 : 6.0;
+        workloads.push_back(generateWorkload(spec, rng()));
+    }
+    return workloads;
+}
+
+using EngineRun = std::function<SchedulerResult(ArrivalSource&, TraceSink&)>;
+
+std::vector<SchedulerResult> runEach(std::vector<std::vector<Process>>& workloads, const EngineRun& run) {
+    std::vector<SchedulerResult> results;
+    results.reserve(workloads.size());
+    NullTraceSink discard;
+    for (std::vector<Process>& workload : workloads) {
+        std::vector<Process*> pointers;
+        for (Process& process : workload) {
+            pointers.push_back(&process);
+        }
+        VectorArrivalSource arrivals(pointers);
+        results.push_back(run(arrivals, discard));
+    }
+    return results;
+}
+
+// Counts workloads whose results differ in any bit.
+size_t mismatches(const std::vector<std::vector<Process>>& expected, const std::vector<SchedulerResult>& expectedResults,
+                  const std::vector<std::vector<Process>>& actual, const std::vector<SchedulerResult>& actualResults) {
+    size_t different = 0;
+    for (size_t w = 0; w < expected.size(); ++w) {
+        const SchedulerResult& a = expectedResults[w];
+        const SchedulerResult& b = actualResults[w];
+        bool same = a.totalCpuTime == b.totalCpuTime && a.totalSimulationTime == b.totalSimulationTime
+            && std::memcmp(&a.cpuUtilization, &b.cpuUtilization, sizeof(double)) == 0;
+        for (size_t i = 0; same && i < expected[w].size(); ++i) {
+            const Process& p = expected[w][i];
+            const Process& q = actual[w][i];
+            same = p.waitingTime == q.waitingTime && p.turnaroundTime == q.turnaroundTime
+                && p.responseTime == q.responseTime && p.longestWait == q.longestWait && p.isCompleted == q.isCompleted;
+        }
+        different += same ? 0 : 1;
+    }
+    return different;
+}
+
+// Best of `repetitions` runs, in milliseconds, keeping the outputs of the
+// last. Copying the workloads is not timed.
+template <typename Function>
+double timeRuns(const std::vector<std::vector<Process>>& prototype, int repetitions, std::vector<std::vector<Process>>& workloads,
+                std::vector<SchedulerResult>& results, Function&& function) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        workloads = prototype;
+        auto start = std::chrono::steady_clock::now();
+        results = function(workloads);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::uint64_t seed = argc > 3 ? static_cast<std::uint64_t>(std::atoll(argv[3])) : 1;
+    const std::vector<std::vector<Process>> prototype = makeWorkloads(count, seed);
+
+    struct Case {
+        const char* name;
+        EngineRun engine;
+        std::function<std::vector<SchedulerResult>(std::vector<std::vector<Process>>&)> batch;
+    };
+    const Case cases[] = {
+        { "FCFS", [](ArrivalSource& a, TraceSink& t) { return schedulerFunction(a, t); },
+          [](std::vector<std::vector<Process>>& w) { return runBatch(w, FcfsPolicy()); } },
+        { "RR q=5", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, RoundRobinPolicy(5), t); },
+          [](std::vector<std::vector<Process>>& w) { return runBatch(w, RoundRobinPolicy(5)); } },
+        { "RR q=2", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, RoundRobinPolicy(2), t); },
+          [](std::vector<std::vector<Process>>& w) { return runBatch(w, RoundRobinPolicy(2)); } },
+    };
+
+    std::printf("%d workloads, %d lanes, best of %d runs\n", count, BatchLanes, repetitions);
+    std::printf("%-8s %12s %12s %9s %12s\n", "Policy", "Engine ms", "Batch ms", "Speedup", "Mismatches");
+    bool identical = true;
+    for (const Case& c : cases) {
+        std::vector<std::vector<Process>> byEngine;
+        std::vector<std::vector<Process>> byBatch;
+        std::vector<SchedulerResult> engineResults;
+        std::vector<SchedulerResult> batchResults;
+        double engineTime = timeRuns(prototype, repetitions, byEngine, engineResults,
+            [&c](std::vector<std::vector<Process>>& w) { return runEach(w, c.engine); });
+        double batchTime = timeRuns(prototype, repetitions, byBatch, batchResults, c.batch);
+        size_t different = mismatches(byEngine, engineResults, byBatch, batchResults);
+        std::printf("%-8s %12.2f %12.2f %8.2fx %12zu\n", c.name, engineTime, batchTime, engineTime / batchTime, different);
+        identical = identical && different == 0;
+    }
+    return identical ? 0 : 1;
+}
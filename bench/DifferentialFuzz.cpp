@@ -0,0 +1,728 @@
+// Runs reference schedulers and the engines that replaced or speed them up
+// side by side on fuzzed workloads, compares their event streams and final
+// metrics, and shrinks the first mismatch of each pair to a minimal workload
+// that still reproduces it. Before fuzzing it checks every policy against the
+// golden files in bench/golden. Exits with status 1 if a golden file or any
+// pair disagreed, and 2 on a bad argument.
+//
+//   g++ -std=c++17 -O2 -I. bench/DifferentialFuzz.cpp -o differential_fuzz -pthread
+//   ./differential_fuzz [cases] [seed] [pair]
+//   ./differential_fuzz --update-golden
+//
+// Every pair sees the same cases for the same seed; a third argument runs
+// only the pairs whose names contain it. The pairs are
+//
+//   legacy-*     the hand-written schedulers in bench/LegacySchedulers.h
+//                against schedulerFunction, SJFschedulerFunction,
+//                SRTFschedulerFunction and mlfqScheduler
+//   batch-*      runBatch against the engine
+//   parallel-*   runParallel against the engine
+//   online-*     a Simulator fed each process at its arrival time, and
+//                stopped at extra times in between, against the engine
+//
+// No pair has an independent reference: the legacy schedulers share the
+// arrival sources, I/O queue and ready queues with the engine, so a bug in
+// those shows up on both sides. The golden files are the fixed point. They
+// hold the trace and final metrics of every policy in standardPolicies() on
+// the built-in workload and on a few seeded ones. For the built-in workload
+// the FCFS and MLFQ sections are what the original program printed, and the
+// SJF section differs only in the turnaround the original got wrong.
+// Lottery is left out, since its draws go through the standard library's
+// distributions, which differ between implementations. --update-golden
+// rewrites the files after an intended change in behaviour.
+//
+// The legacy SJF and MLFQ schedulers compute turnaround as I/O completion
+// minus the start of the last I/O plus waiting time, so those pairs take the
+// reference's turnaround from its own event stream instead. No legacy
+// scheduler tracks longestWait, so the legacy pairs leave it out. Only the
+// legacy and online pairs have event streams to compare. A shrunk workload
+// is printed in the text trace format, so it can be saved and replayed with
+// CPUScheduling <file>.
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench/LegacySchedulers.h"
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/BatchScheduler.h"
+#include "scheduler/Comparison.h"
+#include "scheduler/CostModel.h"
+#include "scheduler/Engine.h"
+#include "scheduler/ParallelEngine.h"
+#include "scheduler/Policies.h"
+#include "scheduler/Process.h"
+#include "scheduler/Schedulers.h"
+#include "scheduler/Simulator.h"
+#include "scheduler/ThreadPool.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+// Where the golden files live. CMake points this at the source tree; a
+// hand-built harness reads them relative to the repository root.
+#ifndef CPUSCHEDULER_GOLDEN_DIR
+#define CPUSCHEDULER_GOLDEN_DIR "bench/golden"
+#endif
+
+// Keeps the whole event stream of a run.
+class EventLog : public TraceSink {
+public:
+    void record(const TraceEvent& event) override { events.push_back(event); }
+
+    std::vector<TraceEvent> events;
+};
+
+// Everything drawn for a case besides the workload. Shrinking keeps it fixed.
+struct CaseSettings {
+    MlfqConfig mlfq;
+    int quantum = 5;
+    size_t segments = 1;
+    CostModel costs;
+    std::vector<int> horizons;   // Extra stops for the online pairs
+};
+
+// What one implementation made of a case.
+struct Outcome {
+    std::vector<TraceEvent> events;
+    SchedulerResult result;
+    std::vector<Process> processes;   // In workload order
+    std::string error;
+};
+
+using Implementation = std::function<Outcome(const std::vector<Process>&, const CaseSettings&)>;
+
+struct Pair {
+    const char* name;
+    Implementation reference;
+    Implementation candidate;
+    bool comparesEvents;
+    bool comparesLongestWait;
+};
+
+// Runs `run(processes, trace)` on a copy of the workload.
+template <typename Run>
+Outcome simulate(const std::vector<Process>& workload, Run&& run) {
+    Outcome outcome;
+    outcome.processes = workload;
+    std::vector<Process*> pointers;
+    for (Process& process : outcome.processes) {
+        pointers.push_back(&process);
+    }
+    EventLog trace;
+    try {
+        outcome.result = run(pointers, trace);
+    }
+    catch (const std::exception& error) {
+        outcome.error = error.what();
+    }
+    outcome.events = std::move(trace.events);
+    return outcome;
+}
+
+// Adapts a scheduler function taking an arrival source and a trace.
+template <typename Scheduler>
+Implementation scheduler(Scheduler function) {
+    return [function](const std::vector<Process>& workload, const CaseSettings& settings) {
+        return simulate(workload, [&](std::vector<Process*>& processes, TraceSink& trace) {
+            VectorArrivalSource arrivals(processes);
+            return function(arrivals, settings, trace);
+        });
+    };
+}
+
+// The engine under the policy makePolicy(settings), charging the case's costs
+// if `charged`.
+template <typename MakePolicy>
+Implementation engine(MakePolicy makePolicy, bool charged) {
+    return scheduler([makePolicy, charged](ArrivalSource& arrivals, const CaseSettings& settings, TraceSink& trace) {
+        Engine<decltype(makePolicy(settings))> run(arrivals, makePolicy(settings), trace);
+        if (charged) {
+            run.setCostModel(settings.costs);
+        }
+        return run.run();
+    });
+}
+
+template <typename MakePolicy>
+Implementation parallel(MakePolicy makePolicy, ThreadPool& pool) {
+    return [makePolicy, &pool](const std::vector<Process>& workload, const CaseSettings& settings) {
+        return simulate(workload, [&](std::vector<Process*>& processes, TraceSink&) {
+            return runParallel(processes, makePolicy(settings), pool, settings.costs, settings.segments);
+        });
+    };
+}
+
+template <typename MakePolicy>
+Implementation online(MakePolicy makePolicy) {
+    return [makePolicy](const std::vector<Process>& workload, const CaseSettings& settings) {
+        return simulate(workload, [&](std::vector<Process*>& processes, TraceSink& trace) {
+            Simulator simulator(makePolicy(settings), trace);
+            simulator.setCostModel(settings.costs);
+            std::vector<Process*> order(processes);
+            std::stable_sort(order.begin(), order.end(), [](const Process* a, const Process* b) {
+                return a->initialArrivalTime < b->initialArrivalTime;
+            });
+            std::vector<int> stops = settings.horizons;
+            for (const Process* process : order) {
+                stops.push_back(process->initialArrivalTime);
+            }
+            std::sort(stops.begin(), stops.end());
+            size_t next = 0;
+            for (int stop : stops) {
+                simulator.advanceUntil(stop);
+                while (next < order.size() && order[next]->initialArrivalTime <= stop) {
+                    simulator.submit(order[next++]);
+                }
+            }
+            return simulator.runToCompletion();
+        });
+    };
+}
+
+Implementation batch(bool roundRobin) {
+    return [roundRobin](const std::vector<Process>& workload, const CaseSettings& settings) {
+        Outcome outcome;
+        std::vector<std::vector<Process>> workloads = { workload };
+        try {
+            outcome.result = roundRobin ? runBatch(workloads, RoundRobinPolicy(settings.quantum))[0]
+                                        : runBatch(workloads, FcfsPolicy())[0];
+        }
+        catch (const std::exception& error) {
+            outcome.error = error.what();
+        }
+        outcome.processes = std::move(workloads[0]);
+        return outcome;
+    };
+}
+
+// Replaces the turnaround `run` reports with the one its events imply: a
+// process finishes at its Completed event, or when its last I/O ends if it
+// has no burst after that I/O.
+Implementation turnaroundFromEvents(Implementation run) {
+    return [run](const std::vector<Process>& workload, const CaseSettings& settings) {
+        Outcome outcome = run(workload, settings);
+        std::map<int, int> finished;
+        for (const TraceEvent& event : outcome.events) {
+            if (event.kind == TraceEventKind::Completed) {
+                finished[event.pid] = event.time;
+            }
+            else if (event.kind == TraceEventKind::IoStart) {
+                finished[event.pid] = event.time + event.value;
+            }
+        }
+        for (Process& process : outcome.processes) {
+            auto end = finished.find(process.pid);
+            if (process.isCompleted && end != finished.end()) {
+                process.turnaroundTime = end->second - process.initialArrivalTime;
+            }
+        }
+        return outcome;
+    };
+}
+
+MlfqConfig withoutGuards(const CaseSettings& settings) {
+    MlfqConfig config = settings.mlfq;
+    config.boostPeriod = 0;
+    config.agingThreshold = 0;
+    return config;
+}
+
+std::string describe(const TraceEvent& event) {
+    std::ostringstream text;
+    formatTraceEvent(event, text);
+    std::string line = text.str();
+    line.erase(std::remove(line.begin(), line.end(), '\n'), line.end());
+    return line;
+}
+
+// The first way the candidate's outcome differs from the reference's, or
+// an empty string if they agree on everything the pair compares.
+std::string firstDifference(const Pair& pair, const Outcome& reference, const Outcome& candidate) {
+    if (reference.error != candidate.error) {
+        return "reference error \"" + reference.error + "\", candidate error \"" + candidate.error + "\"";
+    }
+    if (pair.comparesEvents) {
+        size_t common = std::min(reference.events.size(), candidate.events.size());
+        for (size_t i = 0; i < common; ++i) {
+            const TraceEvent& a = reference.events[i];
+            const TraceEvent& b = candidate.events[i];
+            if (a.time != b.time || a.pid != b.pid || a.kind != b.kind || a.value != b.value || a.detail != b.detail) {
+                return "event " + std::to_string(i) + ": reference \"" + describe(a) + "\", candidate \"" + describe(b) + "\"";
+            }
+        }
+        if (reference.events.size() != candidate.events.size()) {
+            return "reference recorded " + std::to_string(reference.events.size()) + " events, candidate "
+                + std::to_string(candidate.events.size());
+        }
+    }
+
+    const SchedulerResult& a = reference.result;
+    const SchedulerResult& b = candidate.result;
+    if (a.totalCpuTime != b.totalCpuTime || a.totalSimulationTime != b.totalSimulationTime || a.overheadTime != b.overheadTime
+        || std::memcmp(&a.cpuUtilization, &b.cpuUtilization, sizeof(double)) != 0) {
+        char line[200];
+        std::snprintf(line, sizeof(line), "totals: reference cpu %lld, time %lld, overhead %lld, util %.17g; candidate cpu %lld, time %lld, overhead %lld, util %.17g",
+            a.totalCpuTime, a.totalSimulationTime, a.overheadTime, a.cpuUtilization,
+            b.totalCpuTime, b.totalSimulationTime, b.overheadTime, b.cpuUtilization);
+        return line;
+    }
+
+    for (size_t i = 0; i < reference.processes.size(); ++i) {
+        const Process& p = reference.processes[i];
+        const Process& q = candidate.processes[i];
+        struct Field {
+            const char* name;
+            int reference;
+            int candidate;
+            bool compared;
+        };
+        const Field fields[] = {
+            { "waitingTime", p.waitingTime, q.waitingTime, true },
+            { "responseTime", p.responseTime, q.responseTime, true },
+            { "isCompleted", p.isCompleted, q.isCompleted, true },
+            { "turnaroundTime", p.turnaroundTime, q.turnaroundTime, true },
+            { "longestWait", p.longestWait, q.longestWait, pair.comparesLongestWait },
+        };
+        for (const Field& field : fields) {
+            if (field.compared && field.reference != field.candidate) {
+                return "P" + std::to_string(p.pid) + " " + field.name + ": reference " + std::to_string(field.reference)
+                    + ", candidate " + std::to_string(field.candidate);
+            }
+        }
+    }
+    return "";
+}
+
+std::string runCase(const Pair& pair, const std::vector<Process>& workload, const CaseSettings& settings) {
+    return firstDifference(pair, pair.reference(workload, settings), pair.candidate(workload, settings));
+}
+
+// Half the time a generated workload of up to 40 processes; otherwise up to
+// a dozen processes with bursts and arrivals of a few units, so that ties,
+// where ordering bugs hide, are common.
+std::vector<Process> fuzzWorkload(std::mt19937_64& rng) {
+    auto uniform = [&rng](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+    std::vector<Process> workload;
+    if (rng() % 2 == 0) {
+        WorkloadSpec spec;
+        spec.processes = uniform(1, 40);
+        spec.maxBursts = uniform(1, 6);
+        spec.meanCpuBurst = uniform(1, 12);
+        spec.meanIoTime = uniform(1, 40);
+        spec.meanInterarrival = rng() % 4 == 0 ? 0.0 : uniform(1, 20);
+        spec.distribution = rng() % 3 == 0 ? BurstDistribution::Pareto : BurstDistribution::Exponential;
+        spec.cpuBoundFraction = rng() % 2 == 0 ? 0.0 : 0.3;
+        workload = generateWorkload(spec, rng());
+    }
+    else {
+        int count = uniform(1, 12);
+        for (int pid = 1; pid <= count; ++pid) {
+            Process process(pid, {}, {});
+            int bursts = uniform(1, 4);
+            for (int k = 0; k < bursts; ++k) {
+                process.cpuBursts.push_back(uniform(1, 4));
+                if (k + 1 < bursts) {
+                    process.ioTimes.push_back(uniform(1, 6));
+                }
+            }
+            process.initialArrivalTime = uniform(0, 12);
+            workload.push_back(process);
+        }
+    }
+    for (Process& process : workload) {
+        process.priority = rng() % 2 == 0 ? 0 : uniform(-20, 19);
+    }
+    return workload;
+}
+
+CaseSettings fuzzSettings(std::mt19937_64& rng, const std::vector<Process>& workload) {
+    auto uniform = [&rng](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+    CaseSettings settings;
+    settings.mlfq.quanta.resize(uniform(1, 4));
+    for (int& quantum : settings.mlfq.quanta) {
+        quantum = uniform(1, 12);
+    }
+    std::sort(settings.mlfq.quanta.begin(), settings.mlfq.quanta.end());
+    if (rng() % 2 == 0) {
+        settings.mlfq.quanta.back() = 0;
+    }
+    settings.mlfq.boostPeriod = rng() % 2 == 0 ? 0 : uniform(5, 60);
+    settings.mlfq.agingThreshold = rng() % 2 == 0 ? 0 : uniform(5, 40);
+    settings.quantum = uniform(1, 8);
+    settings.segments = static_cast<size_t>(uniform(1, 8));
+    if (rng() % 2 == 0) {
+        settings.costs.switchCost = uniform(0, 2);
+        settings.costs.coldCost = uniform(0, 3);
+        settings.costs.coldAfter = uniform(0, 20);
+        settings.costs.dispatchCost = { uniform(0, 2), uniform(0, 2) };
+    }
+    int lastArrival = 0;
+    for (const Process& process : workload) {
+        lastArrival = std::max(lastArrival, process.initialArrivalTime);
+    }
+    for (int stops = uniform(0, 4); stops > 0; --stops) {
+        settings.horizons.push_back(uniform(0, lastArrival));
+    }
+    return settings;
+}
+
+// Every workload one step simpler than `workload`: without one process,
+// without one burst, with one number closer to its minimum, or with the
+// pids renumbered in arrival order. Most drastic first.
+std::vector<std::vector<Process>> simplifications(const std::vector<Process>& workload) {
+    std::vector<std::vector<Process>> candidates;
+    for (size_t i = 0; i < workload.size(); ++i) {
+        candidates.push_back(workload);
+        candidates.back().erase(candidates.back().begin() + i);
+    }
+    for (size_t i = 0; i < workload.size(); ++i) {
+        for (size_t k = 0; workload[i].cpuBursts.size() > 1 && k < workload[i].cpuBursts.size(); ++k) {
+            candidates.push_back(workload);
+            Process& process = candidates.back()[i];
+            process.cpuBursts.erase(process.cpuBursts.begin() + k);
+            if (!process.ioTimes.empty()) {
+                process.ioTimes.erase(process.ioTimes.begin() + std::min(k, process.ioTimes.size() - 1));
+            }
+        }
+    }
+    auto lower = [&candidates, &workload](size_t i, int Process::*field, int minimum) {
+        int value = workload[i].*field;
+        for (int simpler : { minimum, value / 2, value - 1 }) {
+            if (simpler >= minimum && simpler < value) {
+                candidates.push_back(workload);
+                candidates.back()[i].*field = simpler;
+            }
+        }
+    };
+    auto lowerBurst = [&candidates, &workload](size_t i, std::vector<int> Process::*bursts, size_t k) {
+        int value = (workload[i].*bursts)[k];
+        for (int simpler : { 1, value / 2, value - 1 }) {
+            if (simpler >= 1 && simpler < value) {
+                candidates.push_back(workload);
+                (candidates.back()[i].*bursts)[k] = simpler;
+            }
+        }
+    };
+    for (size_t i = 0; i < workload.size(); ++i) {
+        lower(i, &Process::initialArrivalTime, 0);
+        for (size_t k = 0; k < workload[i].cpuBursts.size(); ++k) {
+            lowerBurst(i, &Process::cpuBursts, k);
+        }
+        for (size_t k = 0; k < workload[i].ioTimes.size(); ++k) {
+            lowerBurst(i, &Process::ioTimes, k);
+        }
+        if (workload[i].priority != 0) {
+            candidates.push_back(workload);
+            candidates.back()[i].priority = 0;
+        }
+    }
+
+    std::vector<size_t> order(workload.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&workload](size_t a, size_t b) {
+        return workload[a].initialArrivalTime < workload[b].initialArrivalTime;
+    });
+    std::vector<Process> renumbered = workload;
+    bool changed = false;
+    for (size_t rank = 0; rank < order.size(); ++rank) {
+        changed = changed || renumbered[order[rank]].pid != static_cast<int>(rank + 1);
+        renumbered[order[rank]].pid = static_cast<int>(rank + 1);
+    }
+    if (changed) {
+        candidates.push_back(renumbered);
+    }
+    return candidates;
+}
+
+// Greedily takes the first simplification that still fails until none does.
+std::vector<Process> shrink(std::vector<Process> workload, const std::function<bool(const std::vector<Process>&)>& fails) {
+    for (bool smaller = true; smaller;) {
+        smaller = false;
+        for (std::vector<Process>& candidate : simplifications(workload)) {
+            if (fails(candidate)) {
+                workload = std::move(candidate);
+                smaller = true;
+                break;
+            }
+        }
+    }
+    return workload;
+}
+
+void printWorkload(const std::vector<Process>& workload, const CaseSettings& settings) {
+    std::printf("  # MLFQ quanta");
+    for (int quantum : settings.mlfq.quanta) {
+        std::printf(" %d", quantum);
+    }
+    std::printf(", boost %d, aging %d; quantum %d; %zu segments; switch %d, cold %d after %d, dispatch",
+        settings.mlfq.boostPeriod, settings.mlfq.agingThreshold, settings.quantum, settings.segments,
+        settings.costs.switchCost, settings.costs.coldCost, settings.costs.coldAfter);
+    for (int cost : settings.costs.dispatchCost) {
+        std::printf(" %d", cost);
+    }
+    std::printf("; stops");
+    for (int horizon : settings.horizons) {
+        std::printf(" %d", horizon);
+    }
+    std::printf("\n  # pid arrival cpu io cpu io ... cpu\n");
+    std::vector<const Process*> order;
+    for (const Process& process : workload) {
+        order.push_back(&process);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Process* a, const Process* b) {
+        return a->initialArrivalTime < b->initialArrivalTime;
+    });
+    for (const Process* process : order) {
+        std::printf("  %d %d", process->pid, process->initialArrivalTime);
+        for (size_t k = 0; k < process->cpuBursts.size(); ++k) {
+            std::printf(" %d", process->cpuBursts[k]);
+            if (k < process->ioTimes.size()) {
+                std::printf(" %d", process->ioTimes[k]);
+            }
+        }
+        if (process->priority != 0) {
+            std::printf("   # nice %d", process->priority);
+        }
+        std::printf("\n");
+    }
+}
+
+// A golden workload of 3 to 10 processes drawn from raw mt19937_64 output,
+// which the standard fixes, so it is the same with every standard library.
+// Some processes end in I/O and half get a nice value.
+std::vector<Process> seededWorkload(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    auto draw = [&rng](int low, int high) { return low + static_cast<int>(rng() % static_cast<std::uint64_t>(high - low + 1)); };
+    std::vector<Process> workload;
+    for (int pid = 1, count = draw(3, 10); pid <= count; ++pid) {
+        Process process(pid, {}, {});
+        for (int bursts = draw(1, 5); bursts > 0; --bursts) {
+            process.cpuBursts.push_back(draw(1, 15));
+            if (bursts > 1 || draw(0, 3) == 0) {
+                process.ioTimes.push_back(draw(1, 30));
+            }
+        }
+        process.initialArrivalTime = draw(0, 40);
+        process.priority = draw(0, 1) == 0 ? 0 : draw(-20, 19);
+        workload.push_back(process);
+    }
+    return workload;
+}
+
+struct GoldenWorkload {
+    std::string name;
+    std::vector<Process> processes;
+};
+
+std::vector<GoldenWorkload> goldenWorkloads() {
+    std::vector<GoldenWorkload> workloads = { { "builtin", builtInWorkload() } };
+    for (std::uint64_t seed = 1; seed <= 3; ++seed) {
+        workloads.push_back({ "seed-" + std::to_string(seed), seededWorkload(seed) });
+    }
+    return workloads;
+}
+
+// The trace and results CPUScheduling prints for each policy, followed by
+// the run's totals.
+std::string goldenOutput(const std::vector<Process>& workload) {
+    std::ostringstream out;
+    StreamTraceSink trace(out);
+    for (const PolicyVariant& variant : standardPolicies()) {
+        if (variant.name == "Lottery") {
+            continue;
+        }
+        std::vector<Process> processes = workload;
+        std::vector<Process*> pointers;
+        for (Process& process : processes) {
+            pointers.push_back(&process);
+        }
+        VectorArrivalSource arrivals(pointers);
+        out << "== " << variant.name << " ==\n";
+        SchedulerResult result = variant.run(arrivals, trace);
+        int maxWait = 0;
+        for (const Process& process : processes) {
+            out << "Process P" << process.pid << ":\n";
+            out << "  Waiting Time (Tw): " << process.waitingTime << "\n";
+            out << "  Turnaround Time (Ttr): " << process.turnaroundTime << "\n";
+            out << "  Response Time (Tr): " << process.responseTime << "\n";
+            maxWait = std::max(maxWait, process.longestWait);
+        }
+        out << "Max Wait: " << maxWait << "\n";
+        out << "CPU Time: " << result.totalCpuTime << ", Simulation Time: " << result.totalSimulationTime << "\n\n";
+    }
+    return out.str();
+}
+
+// Compares every golden workload's output with its file, or rewrites the
+// files if `update`. False if any file is missing or differs.
+bool checkGoldenFiles(bool update) {
+    bool matched = true;
+    for (const GoldenWorkload& workload : goldenWorkloads()) {
+        std::string path = std::string(CPUSCHEDULER_GOLDEN_DIR) + "/" + workload.name + ".txt";
+        std::string actual = goldenOutput(workload.processes);
+        if (update) {
+            std::ofstream file(path, std::ios::binary);
+            if (!(file << actual)) {
+                std::printf("golden %-13s cannot write %s\n", workload.name.c_str(), path.c_str());
+                matched = false;
+            }
+            continue;
+        }
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::printf("golden %-13s cannot read %s\n", workload.name.c_str(), path.c_str());
+            matched = false;
+            continue;
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        std::istringstream expectedLines(contents.str());
+        std::istringstream actualLines(actual);
+        std::string expectedLine;
+        std::string actualLine;
+        int line = 0;
+        bool same = true;
+        while (same) {
+            ++line;
+            bool moreExpected = static_cast<bool>(std::getline(expectedLines, expectedLine));
+            bool moreActual = static_cast<bool>(std::getline(actualLines, actualLine));
+            if (!moreExpected && !moreActual) {
+                break;
+            }
+            same = moreExpected == moreActual && expectedLine == actualLine;
+        }
+        if (same) {
+            std::printf("golden %-13s ok\n", workload.name.c_str());
+        }
+        else {
+            std::printf("golden %-13s line %d: expected \"%s\", got \"%s\"\n", workload.name.c_str(), line,
+                expectedLines ? expectedLine.c_str() : "(end of file)", actualLines ? actualLine.c_str() : "(end of output)");
+            matched = false;
+        }
+    }
+    return matched;
+}
+
+void printUsage(std::FILE* out) {
+    std::fprintf(out, "usage: differential_fuzz [cases] [seed] [pair]\n"
+                      "       differential_fuzz --update-golden\n");
+}
+
+// Parses a whole argument as a decimal number no larger than `limit`.
+bool parseCount(const char* text, unsigned long long limit, unsigned long long& value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0 && value <= limit;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && std::strcmp(argv[1], "--help") == 0) {
+        printUsage(stdout);
+        return 0;
+    }
+    if (argc == 2 && std::strcmp(argv[1], "--update-golden") == 0) {
+        return checkGoldenFiles(true) ? 0 : 1;
+    }
+    unsigned long long cases = 2000;
+    unsigned long long seed = 1;
+    std::string only = argc > 3 ? argv[3] : "";
+    if (argc > 4 || (argc > 1 && !parseCount(argv[1], INT_MAX, cases)) || (argc > 2 && !parseCount(argv[2], ULLONG_MAX, seed))) {
+        printUsage(stderr);
+        return 2;
+    }
+    ThreadPool pool(4);
+
+    auto fcfs = [](const CaseSettings&) { return FcfsPolicy(); };
+    auto sjf = [](const CaseSettings&) { return SjfPolicy(); };
+    auto srtf = [](const CaseSettings&) { return SrtfPolicy(); };
+    auto roundRobin = [](const CaseSettings& settings) { return RoundRobinPolicy(settings.quantum); };
+    auto mlfq = [](const CaseSettings& settings) { return MlfqPolicy(settings.mlfq); };
+    auto priority = [](const CaseSettings&) { return PriorityPolicy(); };
+    auto cfs = [](const CaseSettings&) { return CfsPolicy(); };
+
+    const Pair pairs[] = {
+        { "legacy-fcfs",
+          scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return legacy::schedulerFunction(a, t); }),
+          scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return schedulerFunction(a, t); }),
+          true, false },
+        { "legacy-sjf",
+          turnaroundFromEvents(scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return legacy::SJFschedulerFunction(a, t); })),
+          scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return SJFschedulerFunction(a, t); }),
+          true, false },
+        { "legacy-srtf",
+          scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return legacy::SRTFschedulerFunction(a, t); }),
+          scheduler([](ArrivalSource& a, const CaseSettings&, TraceSink& t) { return SRTFschedulerFunction(a, t); }),
+          true, false },
+        { "legacy-mlfq",
+          turnaroundFromEvents(scheduler([](ArrivalSource& a, const CaseSettings& s, TraceSink& t) { return legacy::mlfqScheduler(a, withoutGuards(s), t); })),
+          scheduler([](ArrivalSource& a, const CaseSettings& s, TraceSink& t) { return mlfqScheduler(a, withoutGuards(s), t); }),
+          true, false },
+        { "batch-fcfs", engine(fcfs, false), batch(false), false, true },
+        { "batch-rr", engine(roundRobin, false), batch(true), false, true },
+        { "parallel-fcfs", engine(fcfs, true), parallel(fcfs, pool), false, true },
+        { "parallel-sjf", engine(sjf, true), parallel(sjf, pool), false, true },
+        { "parallel-srtf", engine(srtf, true), parallel(srtf, pool), false, true },
+        { "parallel-rr", engine(roundRobin, true), parallel(roundRobin, pool), false, true },
+        { "parallel-mlfq", engine(mlfq, true), parallel(mlfq, pool), false, true },
+        { "parallel-priority", engine(priority, true), parallel(priority, pool), false, true },
+        { "online-srtf", engine(srtf, true), online(srtf), true, true },
+        { "online-rr", engine(roundRobin, true), online(roundRobin), true, true },
+        { "online-mlfq", engine(mlfq, true), online(mlfq), true, true },
+        { "online-cfs", engine(cfs, true), online(cfs), true, true },
+    };
+
+    if (std::none_of(std::begin(pairs), std::end(pairs), [&only](const Pair& pair) { return std::string(pair.name).find(only) != std::string::npos; })) {
+        std::fprintf(stderr, "no pair matches \"%s\"\n", only.c_str());
+        printUsage(stderr);
+        return 2;
+    }
+
+    bool agreed = checkGoldenFiles(false);
+    std::printf("%llu cases per pair, seed %llu\n", cases, seed);
+    for (const Pair& pair : pairs) {
+        if (std::string(pair.name).find(only) == std::string::npos) {
+            continue;
+        }
+        std::mt19937_64 rng(seed);
+        int mismatches = 0;
+        for (int c = 0; c < static_cast<int>(cases); ++c) {
+            std::vector<Process> workload = fuzzWorkload(rng);
+            CaseSettings settings = fuzzSettings(rng, workload);
+            std::string difference = runCase(pair, workload, settings);
+            if (difference.empty()) {
+                continue;
+            }
+            if (mismatches++ == 0) {
+                std::printf("%s: case %d differs: %s\n", pair.name, c, difference.c_str());
+                std::vector<Process> minimal = shrink(workload, [&pair, &settings](const std::vector<Process>& candidate) {
+                    return !runCase(pair, candidate, settings).empty();
+                });
+                std::printf("  shrunk from %zu to %zu processes: %s\n", workload.size(), minimal.size(),
+                    runCase(pair, minimal, settings).c_str());
+                printWorkload(minimal, settings);
+            }
+        }
+        std::printf("%-20s %s\n", pair.name, mismatches == 0 ? "ok" : (std::to_string(mismatches) + " of " + std::to_string(cases) + " cases differ").c_str());
+        agreed = agreed && mismatches == 0;
+    }
+    return agreed ? 0 : 1;
+}
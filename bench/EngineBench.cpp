@@ -0,0 +1,109 @@
+// Times the policy-templated Engine against the hand-written schedulers it
+// replaced, on the same synthetic workload, and checks that both produce the
+// same event stream.
+//
+//   g++ -std=c++17 -O2 -I. bench/EngineBench.cpp -o engine_bench
+//   ./engine_bench [processCount] [repetitions]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "bench/LegacySchedulers.h"
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Process.h"
+#include "scheduler/Schedulers.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+// Folds every event into a running hash, so two runs can be compared cheaply.
+class HashingTraceSink : public TraceSink {
+public:
+    void record(const TraceEvent& event) override {
+        const std::int32_t fields[5] = { event.time, event.pid, static_cast<std::int32_t>(event.kind),
+                                         event.value, event.detail };
+        for (std::int32_t field : fields) {
+            hash = (hash ^ static_cast<std::uint32_t>(field)) * 1099511628211ull;
+        }
+        count++;
+    }
+
+    std::uint64_t hash = 14695981039346656037ull;
+    size_t count = 0;
+};
+
+using Scheduler = std::function<SchedulerResult(ArrivalSource&, TraceSink&)>;
+
+// Best of `repetitions` runs, in milliseconds. Cloning the workload is not timed.
+double timeScheduler(const std::vector<Process>& prototype, const Scheduler& scheduler, int repetitions) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        std::vector<Process> processes(prototype);
+        std::vector<Process*> pointers;
+        for (Process& process : processes) {
+            pointers.push_back(&process);
+        }
+        VectorArrivalSource arrivals(pointers);
+        NullTraceSink sink;
+        auto start = std::chrono::steady_clock::now();
+        scheduler(arrivals, sink);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+HashingTraceSink traceOf(const std::vector<Process>& prototype, const Scheduler& scheduler) {
+    std::vector<Process> processes(prototype);
+    std::vector<Process*> pointers;
+    for (Process& process : processes) {
+        pointers.push_back(&process);
+    }
+    VectorArrivalSource arrivals(pointers);
+    HashingTraceSink sink;
+    scheduler(arrivals, sink);
+    return sink;
+}
+
+int main(int argc, char** argv) {
+    WorkloadSpec spec;
+    spec.processes = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::vector<Process> workload = generateWorkload(spec, 7);
+
+    struct Pair {
+        const char* name;
+        Scheduler handWritten;
+        Scheduler templated;
+    };
+    const std::vector<Pair> pairs = {
+        { "FCFS", [](ArrivalSource& a, TraceSink& t) { return legacy::schedulerFunction(a, t); },
+                  [](ArrivalSource& a, TraceSink& t) { return schedulerFunction(a, t); } },
+        { "SJF",  [](ArrivalSource& a, TraceSink& t) { return legacy::SJFschedulerFunction(a, t); },
+                  [](ArrivalSource& a, TraceSink& t) { return SJFschedulerFunction(a, t); } },
+        { "SRTF", [](ArrivalSource& a, TraceSink& t) { return legacy::SRTFschedulerFunction(a, t); },
+                  [](ArrivalSource& a, TraceSink& t) { return SRTFschedulerFunction(a, t); } },
+        { "MLFQ", [](ArrivalSource& a, TraceSink& t) { return legacy::mlfqScheduler(a, MlfqConfig(), t); },
+                  [](ArrivalSource& a, TraceSink& t) { return mlfqScheduler(a, t); } },
+    };
+
+    std::printf("%d processes, best of %d runs\n\n", spec.processes, repetitions);
+    std::printf("%-6s %12s %16s %14s %10s %8s\n", "policy", "events", "hand-written ms", "templated ms", "speedup", "trace");
+    bool allMatch = true;
+    for (const Pair& pair : pairs) {
+        HashingTraceSink before = traceOf(workload, pair.handWritten);
+        HashingTraceSink after = traceOf(workload, pair.templated);
+        bool match = before.hash == after.hash && before.count == after.count;
+        allMatch = allMatch && match;
+        double handWritten = timeScheduler(workload, pair.handWritten, repetitions);
+        double templated = timeScheduler(workload, pair.templated, repetitions);
+        std::printf("%-6s %12zu %16.2f %14.2f %9.2fx %8s\n", pair.name, after.count, handWritten, templated,
+            handWritten / templated, match ? "same" : "DIFFERS");
+    }
+    return allMatch ? 0 : 1;
+}
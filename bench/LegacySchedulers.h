@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Engine.h"
+#include "scheduler/IoEventQueue.h"
+#include "scheduler/Policies.h"
+#include "scheduler/Process.h"
+#include "scheduler/ProcessRing.h"
+#include "scheduler/ReadyHeap.h"
+#include "scheduler/TraceSink.h"
+
+
+// Hand-written single-CPU schedulers in the shape of the ones before Engine,
+// kept so the benchmarks can time and cross-check the engine against them.
+// They are not the original code, which printed straight to std::cout and
+// started every process at time 0: they were rewritten onto the same
+// ArrivalSource, IoEventQueue, ReadyHeap and ProcessRing the engine uses, so
+// they are no independent reference for any of those. The golden files in
+// bench/golden are; see bench/DifferentialFuzz.cpp. Event traces match the
+// engine's; turnaround times in SJF and MLFQ use the old arithmetic.
+namespace legacy {
+
+inline SchedulerResult schedulerFunction(ArrivalSource& arrivals, TraceSink& trace) {
+    int currentTime = 0;
+    int totalCpuTime = 0;          // Total CPU time used
+    int totalSimulationTime = 0;   // Total time from start to completion of all processes
+
+    std::vector<Process*> readyQueue;
+    IoEventQueue ioQueue;
+
+    // Admit every process whose arrival time has been reached
+    auto admitArrivals = [&]() {
+        while (arrivals.nextArrivalTime() <= currentTime) {
+            Process* process = arrivals.admit();
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = process->initialArrivalTime;
+            readyQueue.push_back(process);
+        }
+    };
+    admitArrivals();
+
+    while (!readyQueue.empty() || !ioQueue.empty() || arrivals.nextArrivalTime() != INT_MAX) {
+        // If ready queue is empty, advance time to the next I/O completion or arrival
+        if (readyQueue.empty()) {
+            currentTime = std::min(ioQueue.nextCompletionTime(), arrivals.nextArrivalTime());
+            admitArrivals();
+
+            // Move processes that have completed I/O back to the ready queue
+            ioQueue.drainUntil(currentTime, [&](Process* process, int) {
+                process->currentBurstIndex++;
+                if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                    process->arrivalTime = currentTime;
+                    readyQueue.push_back(process);
+                }
+                else {
+                    // Process has completed all CPU bursts
+                    process->isCompleted = true;
+                    process->turnaroundTime = currentTime - process->initialArrivalTime;
+                    arrivals.retire(process);
+                }
+            });
+
+            continue; // Go back to the beginning of the loop
+        }
+
+        // Schedule the next process from the ready queue (FCFS)
+        Process* currentProcess = readyQueue.front();
+        readyQueue.erase(readyQueue.begin());
+
+        // Record response time if not already set
+        if (currentProcess->responseTime == -1) {
+            currentProcess->responseTime = currentTime - currentProcess->initialArrivalTime;
+        }
+
+        // Update waiting time
+        currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
+
+        // Run the CPU burst
+        trace.record({ currentTime, currentProcess->pid, TraceEventKind::RunBurst, currentProcess->remainingCpuTime, 0 });
+        currentTime += currentProcess->remainingCpuTime;
+        totalCpuTime += currentProcess->remainingCpuTime; // Accumulate CPU time
+
+        // Check if there is a corresponding I/O burst
+        if (currentProcess->currentBurstIndex < static_cast<int>(currentProcess->ioTimes.size())) {
+            // Set remaining I/O time
+            currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
+            currentProcess->arrivalTime = currentTime;
+            ioQueue.push(currentProcess);
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::IoStart, currentProcess->remainingIoTime, 0 });
+        }
+        else {
+            // Process has completed all CPU bursts
+            currentProcess->isCompleted = true;
+            currentProcess->turnaroundTime = currentTime - currentProcess->initialArrivalTime;
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::Completed, 0, 0 });
+            arrivals.retire(currentProcess);
+        }
+
+        // Admit new arrivals, then move processes that have completed I/O back to the ready queue
+        admitArrivals();
+        ioQueue.drainUntil(currentTime, [&](Process* process, int completionTime) {
+            process->currentBurstIndex++;
+            if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                process->arrivalTime = completionTime;
+                readyQueue.push_back(process);
+            }
+            else {
+                // Process has completed all CPU bursts
+                process->isCompleted = true;
+                process->turnaroundTime = completionTime - process->initialArrivalTime;
+                arrivals.retire(process);
+            }
+        });
+    }
+
+    totalSimulationTime = currentTime;
+
+    // Calculate CPU utilization
+    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
+
+    // Report CPU utilization
+    trace.record({ totalSimulationTime, 0, TraceEventKind::RunFinished, totalCpuTime, totalSimulationTime });
+    return { totalCpuTime, totalSimulationTime, cpuUtilization };
+}
+
+inline SchedulerResult SJFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace) {
+    int currentTime = 0;
+    int totalCpuTime = 0;
+    int totalSimulationTime = 0;
+
+    ReadyHeap readyQueue;
+    IoEventQueue ioQueue;
+
+    // Admit every process whose arrival time has been reached
+    auto admitArrivals = [&]() {
+        while (arrivals.nextArrivalTime() <= currentTime) {
+            Process* process = arrivals.admit();
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = process->initialArrivalTime;
+            readyQueue.push(process);
+        }
+    };
+    admitArrivals();
+
+    while (!readyQueue.empty() || !ioQueue.empty() || arrivals.nextArrivalTime() != INT_MAX) {
+        // Admit new arrivals, then move processes that have completed I/O back to the ready queue
+        admitArrivals();
+        ioQueue.drainUntil(currentTime, [&](Process* process, int ioCompletionTime) {
+            // I/O is complete
+            process->currentBurstIndex++;
+            if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                process->arrivalTime = ioCompletionTime;
+                readyQueue.push(process);
+            }
+            else {
+                // Process has completed all CPU bursts
+                process->isCompleted = true;
+                process->turnaroundTime = ioCompletionTime - process->arrivalTime + process->waitingTime;
+                arrivals.retire(process);
+            }
+        });
+
+        // If ready queue is empty, advance time to the next I/O completion or arrival
+        if (readyQueue.empty()) {
+            currentTime = std::min(ioQueue.nextCompletionTime(), arrivals.nextArrivalTime());
+            continue;
+        }
+
+        // Select the process with the shortest next CPU burst
+        Process* currentProcess = readyQueue.pop();
+
+        // Record response time if not already set
+        if (currentProcess->responseTime == -1) {
+            currentProcess->responseTime = currentTime - currentProcess->arrivalTime;
+        }
+
+        // Update waiting time
+        currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
+
+        // Run the CPU burst
+        trace.record({ currentTime, currentProcess->pid, TraceEventKind::RunBurst, currentProcess->remainingCpuTime, 0 });
+        currentTime += currentProcess->remainingCpuTime;
+        totalCpuTime += currentProcess->remainingCpuTime;
+
+        // Check if there is a corresponding I/O burst
+        if (currentProcess->currentBurstIndex < static_cast<int>(currentProcess->ioTimes.size())) {
+            // Set remaining I/O time
+            currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
+            currentProcess->arrivalTime = currentTime;
+            ioQueue.push(currentProcess);
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::IoStart, currentProcess->remainingIoTime, 0 });
+        }
+        else {
+            // Process has completed all CPU bursts
+            currentProcess->isCompleted = true;
+            currentProcess->turnaroundTime = currentTime - currentProcess->arrivalTime + currentProcess->waitingTime;
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::Completed, 0, 0 });
+            arrivals.retire(currentProcess);
+        }
+    }
+
+    totalSimulationTime = currentTime;
+
+    // Calculate CPU utilization
+    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
+
+    // Report CPU utilization
+    trace.record({ totalSimulationTime, 0, TraceEventKind::RunFinished, totalCpuTime, totalSimulationTime });
+    return { totalCpuTime, totalSimulationTime, cpuUtilization };
+}
+
+inline SchedulerResult SRTFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace) {
+    int currentTime = 0;
+    int totalCpuTime = 0;
+    int totalSimulationTime = 0;
+
+    // The running process stays at the top of the heap while it runs, so its
+    // shrinking remaining time is a decrease-key rather than a pop and push.
+    ReadyHeap readyQueue;
+    IoEventQueue ioQueue;
+
+    // Admit every process whose arrival time has been reached
+    auto admitArrivals = [&]() {
+        while (arrivals.nextArrivalTime() <= currentTime) {
+            Process* process = arrivals.admit();
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = process->initialArrivalTime;
+            readyQueue.push(process);
+        }
+    };
+    admitArrivals();
+
+    Process* currentProcess = nullptr;
+
+    while (!readyQueue.empty() || !ioQueue.empty() || arrivals.nextArrivalTime() != INT_MAX) {
+        // Admit new arrivals, then move processes that have completed I/O back to the ready queue
+        admitArrivals();
+        ioQueue.drainUntil(currentTime, [&](Process* process, int ioCompletionTime) {
+            process->currentBurstIndex++;
+            if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                process->arrivalTime = ioCompletionTime;
+                readyQueue.push(process);
+            }
+            else {
+                // Process has completed all CPU bursts
+                process->isCompleted = true;
+                process->turnaroundTime = ioCompletionTime - process->initialArrivalTime;
+                arrivals.retire(process);
+            }
+        });
+
+        // If ready queue is empty, advance time to the next I/O completion or arrival
+        if (readyQueue.empty()) {
+            currentTime = std::min(ioQueue.nextCompletionTime(), arrivals.nextArrivalTime());
+            continue;
+        }
+
+        // Preempt only for a strictly shorter remaining time, not on a PID tie
+        Process* shortest = readyQueue.top();
+        if (currentProcess != nullptr && shortest != currentProcess
+            && shortest->remainingCpuTime < currentProcess->remainingCpuTime) {
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::PreemptedBy, currentProcess->remainingCpuTime, shortest->pid });
+            currentProcess->arrivalTime = currentTime;
+            currentProcess = nullptr;
+        }
+
+        if (currentProcess == nullptr) {
+            currentProcess = shortest;
+
+            // Record response time if not already set
+            if (currentProcess->responseTime == -1) {
+                currentProcess->responseTime = currentTime - currentProcess->initialArrivalTime;
+            }
+
+            // Update waiting time
+            currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::RunBurst, currentProcess->remainingCpuTime, 0 });
+        }
+
+        // Run until the burst ends or the next I/O completion or arrival, which may preempt
+        int nextEventTime = std::min(ioQueue.nextCompletionTime(), arrivals.nextArrivalTime());
+        int executionTime = currentProcess->remainingCpuTime;
+        if (nextEventTime != INT_MAX) {
+            executionTime = std::min(executionTime, nextEventTime - currentTime);
+        }
+        currentTime += executionTime;
+        totalCpuTime += executionTime;
+        currentProcess->remainingCpuTime -= executionTime;
+
+        if (currentProcess->remainingCpuTime > 0) {
+            readyQueue.decreaseKey(currentProcess);
+            continue;
+        }
+
+        // An equal-length arrival may have taken the top slot without preempting
+        readyQueue.remove(currentProcess);
+
+        // Check if there is a corresponding I/O burst
+        if (currentProcess->currentBurstIndex < static_cast<int>(currentProcess->ioTimes.size())) {
+            // Set remaining I/O time
+            currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
+            currentProcess->arrivalTime = currentTime;
+            ioQueue.push(currentProcess);
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::IoStart, currentProcess->remainingIoTime, 0 });
+        }
+        else {
+            // Process has completed all CPU bursts
+            currentProcess->isCompleted = true;
+            currentProcess->turnaroundTime = currentTime - currentProcess->initialArrivalTime;
+
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::Completed, 0, 0 });
+            arrivals.retire(currentProcess);
+        }
+        currentProcess = nullptr;
+    }
+
+    totalSimulationTime = currentTime;
+
+    // Calculate CPU utilization
+    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
+
+    // Report CPU utilization
+    trace.record({ totalSimulationTime, 0, TraceEventKind::RunFinished, totalCpuTime, totalSimulationTime });
+    return { totalCpuTime, totalSimulationTime, cpuUtilization };
+}
+
+inline SchedulerResult mlfqScheduler(ArrivalSource& arrivals, const MlfqConfig& config, TraceSink& trace) {
+    if (!config.valid()) {
+        throw std::invalid_argument("MLFQ needs at least one level and positive quanta above the last level");
+    }
+
+    int currentTime = 0;
+    int totalCpuTime = 0;
+    int totalSimulationTime = 0;
+
+    // Ready queues for each level, highest priority first
+    const int levels = config.levels();
+    std::vector<ProcessRing> queues(levels);
+
+    IoEventQueue ioQueue; // Processes performing I/O
+
+    // Admit every process whose arrival time has been reached
+    auto admitArrivals = [&]() {
+        while (arrivals.nextArrivalTime() <= currentTime) {
+            Process* process = arrivals.admit();
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = process->initialArrivalTime;
+            process->queueLevel = 1;  // Start at highest priority queue
+            queues[0].push(process);
+        }
+    };
+    admitArrivals();
+
+    // Move processes that have completed I/O back to their current queue level
+    auto completeIo = [&](Process* process, int ioCompletionTime) {
+        process->currentBurstIndex++;
+        if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = ioCompletionTime;
+            process->timeSliceUsed = 0; // Reset time slice used
+            queues[process->queueLevel - 1].push(process);
+        }
+        else {
+            // Process has completed all CPU bursts
+            process->isCompleted = true;
+            process->turnaroundTime = ioCompletionTime - process->arrivalTime + process->waitingTime;
+            arrivals.retire(process);
+        }
+    };
+
+    auto anyReady = [&]() {
+        for (const ProcessRing& queue : queues) {
+            if (!queue.empty()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    Process* currentProcess = nullptr;
+    int timeQuantum = 0;
+
+    while (currentProcess != nullptr || anyReady() || !ioQueue.empty() || arrivals.nextArrivalTime() != INT_MAX) {
+        // Admit new arrivals, then move processes that have completed I/O back to the appropriate queue
+        admitArrivals();
+        ioQueue.drainUntil(currentTime, completeIo);
+
+        // Work waiting at the top level preempts a process running at any lower level
+        bool preempt = currentProcess != nullptr && currentProcess->queueLevel > 1 && !queues[0].empty();
+
+        // If preemption occurs or no process is running, select the next process
+        if (currentProcess == nullptr || preempt) {
+            if (preempt) {
+                // Preempt the current process and place it back into its queue
+                trace.record({ currentTime, currentProcess->pid, TraceEventKind::PreemptedToLevel, 0, currentProcess->queueLevel });
+                queues[currentProcess->queueLevel - 1].push(currentProcess);
+                currentProcess = nullptr;
+            }
+
+            // Select the next process from the highest priority non-empty queue
+            int level = 0;
+            while (level < levels && queues[level].empty()) {
+                level++;
+            }
+            if (level == levels) {
+                // No process is ready; advance time to next I/O completion or arrival
+                currentTime = std::min(ioQueue.nextCompletionTime(), arrivals.nextArrivalTime());
+                continue;
+            }
+            currentProcess = queues[level].front();
+            queues[level].pop();
+            timeQuantum = config.quanta[level];
+            if (timeQuantum == 0) {
+                timeQuantum = currentProcess->remainingCpuTime; // For FCFS, run until completion
+            }
+
+            // Record response time if not already set
+            if (currentProcess->responseTime == -1) {
+                currentProcess->responseTime = currentTime - currentProcess->arrivalTime;
+            }
+
+            // Update waiting time
+            currentProcess->waitingTime += currentTime - currentProcess->arrivalTime;
+            currentProcess->timeSliceUsed = 0; // Reset time slice used
+        }
+
+        // Determine execution time for the current time slice
+        int executionTime = std::min({ currentProcess->remainingCpuTime, timeQuantum - currentProcess->timeSliceUsed });
+
+        // Simulate execution
+        trace.record({ currentTime, currentProcess->pid, TraceEventKind::RunSlice, executionTime, currentProcess->queueLevel });
+
+        currentTime += executionTime;
+        totalCpuTime += executionTime;
+        currentProcess->remainingCpuTime -= executionTime;
+        currentProcess->timeSliceUsed += executionTime;
+
+        // Admit arrivals and move processes that have completed I/O back to the appropriate queue during execution
+        admitArrivals();
+        ioQueue.drainUntil(currentTime, completeIo);
+
+        // Check if the current process has completed its CPU burst
+        if (currentProcess->remainingCpuTime == 0) {
+            // CPU burst is complete
+            trace.record({ currentTime, currentProcess->pid, TraceEventKind::BurstComplete, 0, 0 });
+            if (currentProcess->currentBurstIndex < static_cast<int>(currentProcess->ioTimes.size())) {
+                // Process has an I/O burst
+                currentProcess->remainingIoTime = currentProcess->ioTimes[currentProcess->currentBurstIndex];
+                currentProcess->arrivalTime = currentTime;
+                ioQueue.push(currentProcess);
+
+                trace.record({ currentTime, currentProcess->pid, TraceEventKind::IoStart, currentProcess->remainingIoTime, 0 });
+            }
+            else {
+                // Process has completed all CPU bursts
+                currentProcess->isCompleted = true;
+                currentProcess->turnaroundTime = currentTime - currentProcess->initialArrivalTime;
+
+                trace.record({ currentTime, currentProcess->pid, TraceEventKind::Completed, 0, 0 });
+                arrivals.retire(currentProcess);
+            }
+            currentProcess = nullptr; // CPU is now idle
+        }
+        else if (currentProcess->timeSliceUsed == timeQuantum) {
+            // Time quantum used up
+            if (currentProcess->queueLevel < levels) {
+                // Demote to next lower queue
+                currentProcess->queueLevel++;
+                trace.record({ currentTime, currentProcess->pid, TraceEventKind::Demoted, 0, currentProcess->queueLevel });
+            }
+            // Reset time slice used
+            currentProcess->timeSliceUsed = 0;
+            currentProcess->arrivalTime = currentTime; // Update arrival time
+            // Place the process back into the appropriate queue
+            queues[currentProcess->queueLevel - 1].push(currentProcess);
+            currentProcess = nullptr; // CPU is now idle
+        }
+        // Else, continue running current process in the next iteration
+    }
+
+    totalSimulationTime = currentTime;
+
+    // Calculate CPU utilization
+    double cpuUtilization = (static_cast<double>(totalCpuTime) / totalSimulationTime) * 100.0;
+
+    // Report CPU utilization
+    trace.record({ totalSimulationTime, 0, TraceEventKind::RunFinished, totalCpuTime, totalSimulationTime });
+    return { totalCpuTime, totalSimulationTime, cpuUtilization };
+}
+
+} // namespace legacy
@@ -0,0 +1,130 @@
+// Times runParallel on one large synthetic workload at 1 to 64 threads
+// against a single sequential engine run, and checks that every process's
+// results and the run totals are bit-identical. Exits with status 1 on any
+// difference.
+//
+//   g++ -std=c++17 -O2 -I. bench/ParallelBench.cpp -o parallel_bench -pthread
+//   ./parallel_bench [processes] [maxThreads] [load] [seed]
+//
+// The speedup depends on how often the CPU goes idle: at the default load of
+// 0.7 there are idle points every few processes, so segments hand over
+// almost at once. Past a load of 1 the backlog never clears and the runs
+// cannot hand over. Speculating costs a third to a half more work at
+// the default load, which only pays off with more hardware threads than one.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Engine.h"
+#include "scheduler/ParallelEngine.h"
+#include "scheduler/Policies.h"
+#include "scheduler/Process.h"
+#include "scheduler/ThreadPool.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+std::vector<Process*> pointersTo(std::vector<Process>& processes) {
+    std::vector<Process*> pointers;
+    pointers.reserve(processes.size());
+    for (Process& process : processes) {
+        pointers.push_back(&process);
+    }
+    return pointers;
+}
+
+// Counts processes whose results differ, plus one if the totals do.
+size_t mismatches(const std::vector<Process>& expected, const SchedulerResult& expectedResult,
+                  const std::vector<Process>& actual, const SchedulerResult& actualResult) {
+    size_t different = expectedResult.totalCpuTime == actualResult.totalCpuTime
+        && expectedResult.totalSimulationTime == actualResult.totalSimulationTime
+        && std::memcmp(&expectedResult.cpuUtilization, &actualResult.cpuUtilization, sizeof(double)) == 0 ? 0 : 1;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const Process& p = expected[i];
+        const Process& q = actual[i];
+        bool same = p.waitingTime == q.waitingTime && p.turnaroundTime == q.turnaroundTime
+            && p.responseTime == q.responseTime && p.longestWait == q.longestWait && p.isCompleted == q.isCompleted;
+        different += same ? 0 : 1;
+    }
+    return different;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Case {
+    const char* name;
+    std::function<SchedulerResult(std::vector<Process>&)> sequential;
+    std::function<SchedulerResult(std::vector<Process>&, ThreadPool&)> parallel;
+};
+
+template <typename Policy>
+Case makeCase(const char* name, Policy policy) {
+    return {
+        name,
+        [policy](std::vector<Process>& processes) {
+            std::vector<Process*> pointers = pointersTo(processes);
+            VectorArrivalSource arrivals(pointers);
+            NullTraceSink discard;
+            return runEngine(arrivals, policy, discard);
+        },
+        [policy](std::vector<Process>& processes, ThreadPool& pool) {
+            return runParallel(pointersTo(processes), policy, pool);
+        },
+    };
+}
+
+int main(int argc, char** argv) {
+    int processCount = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 64;
+    double load = argc > 3 ? std::atof(argv[3]) : 0.7;
+    std::uint64_t seed = argc > 4 ? static_cast<std::uint64_t>(std::atoll(argv[4])) : 1;
+
+    WorkloadSpec spec;
+    spec.processes = processCount;
+    spec.maxBursts = 6;
+    spec.meanIoTime = 40.0;
+    spec.meanInterarrival = meanCpuDemand(spec) / load;
+    const std::vector<Process> prototype = generateWorkload(spec, seed);
+
+    const Case cases[] = {
+        makeCase("FCFS", FcfsPolicy()),
+        makeCase("SJF", SjfPolicy()),
+        makeCase("SRTF", SrtfPolicy()),
+        makeCase("RR", RoundRobinPolicy(5)),
+        makeCase("MLFQ", MlfqPolicy(MlfqConfig())),
+        makeCase("Priority", PriorityPolicy()),
+    };
+
+    std::printf("%d processes, load %.2f, %u hardware threads\n", processCount, load, std::thread::hardware_concurrency());
+    std::printf("%-10s %8s %12s %9s %12s\n", "Policy", "Threads", "ms", "Speedup", "Mismatches");
+    bool identical = true;
+    for (const Case& c : cases) {
+        std::vector<Process> expected = prototype;
+        auto start = std::chrono::steady_clock::now();
+        SchedulerResult expectedResult = c.sequential(expected);
+        double sequentialTime = millisecondsSince(start);
+        std::printf("%-10s %8s %12.1f %8.2fx %12s\n", c.name, "seq", sequentialTime, 1.0, "-");
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            ThreadPool pool(threads);
+            std::vector<Process> actual = prototype;
+            start = std::chrono::steady_clock::now();
+            SchedulerResult actualResult = c.parallel(actual, pool);
+            double parallelTime = millisecondsSince(start);
+            size_t different = mismatches(expected, expectedResult, actual, actualResult);
+            std::printf("%-10s %8u %12.1f %8.2fx %12zu\n", c.name, threads, parallelTime, sequentialTime / parallelTime, different);
+            identical = identical && different == 0;
+        }
+    }
+    return identical ? 0 : 1;
+}
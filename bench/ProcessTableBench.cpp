@@ -0,0 +1,234 @@
+// Compares the memory footprint and cache behaviour of a vector of Process
+// pointers against the struct-of-arrays ProcessTable. Both sides run the same
+// synthetic loop, not a scheduler; no scheduling path uses the table.
+//
+//   g++ -std=c++17 -O2 -I. bench/ProcessTableBench.cpp -o process_table_bench
+//   ./process_table_bench [processCount] [steps]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "scheduler/Process.h"
+#include "scheduler/ProcessTable.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Every allocation in the benchmark goes through here so the footprint of each
+// layout can be measured, including the per-vector allocations of Process.
+static size_t allocatedBytes = 0;
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocatedBytes += size;
+    allocationCount++;
+    if (void* memory = std::malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+// Hardware cache-miss counter for the calling thread. Reports -1 when perf
+// events are unavailable (non-Linux hosts, containers, perf_event_paranoid).
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if (read(fd, &count, sizeof(count)) == sizeof(count)) {
+                return count;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd = -1;
+};
+
+struct Timing {
+    double nsPerStep;
+    long long cacheMisses;
+    long long checksum;
+};
+
+// One scheduling step: dispatch a process, account its wait, and move it on to
+// its next CPU burst. This touches the same fields the schedulers do.
+static long long runPointers(std::vector<Process*>& processes, const std::vector<ProcessIndex>& order) {
+    long long checksum = 0;
+    int currentTime = 0;
+    for (ProcessIndex index : order) {
+        Process* process = processes[index];
+        process->waitingTime += currentTime - process->arrivalTime;
+        currentTime += process->remainingCpuTime;
+        process->timeSliceUsed = process->remainingCpuTime;
+        process->currentBurstIndex = (process->currentBurstIndex + 1) % static_cast<int>(process->cpuBursts.size());
+        process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+        process->arrivalTime = currentTime;
+        checksum += process->waitingTime;
+    }
+    return checksum;
+}
+
+static long long runTable(ProcessTable& table, const std::vector<ProcessIndex>& order) {
+    long long checksum = 0;
+    int currentTime = 0;
+    for (ProcessIndex index : order) {
+        table.waitingTime[index] += currentTime - table.arrivalTime[index];
+        currentTime += table.remainingCpuTime[index];
+        table.timeSliceUsed[index] = table.remainingCpuTime[index];
+        table.currentBurstIndex[index] = (table.currentBurstIndex[index] + 1) % table.cpuBurstCount(index);
+        table.remainingCpuTime[index] = table.cpuBurst(index, table.currentBurstIndex[index]);
+        table.arrivalTime[index] = currentTime;
+        checksum += table.waitingTime[index];
+    }
+    return checksum;
+}
+
+template <typename Run>
+static Timing measure(size_t steps, Run&& run) {
+    Timing timing{};
+    CacheMissCounter counter;
+    auto start = std::chrono::steady_clock::now();
+    counter.start();
+    timing.checksum = run();
+    timing.cacheMisses = counter.stop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    timing.nsPerStep = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(steps);
+    return timing;
+}
+
+static void printTiming(const char* layout, const char* order, const Timing& timing) {
+    std::printf("%-18s %-12s %10.2f ", layout, order, timing.nsPerStep);
+    if (timing.cacheMisses >= 0) {
+        std::printf("%14lld\n", timing.cacheMisses);
+    }
+    else {
+        std::printf("%14s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t processCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t steps = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : processCount * 4;
+
+    // Generate the bursts once so both layouts hold identical workloads
+    std::mt19937 rng(42);
+    std::vector<std::vector<int>> cpu(processCount);
+    std::vector<std::vector<int>> io(processCount);
+    size_t burstCount = 0;
+    for (size_t i = 0; i < processCount; ++i) {
+        size_t bursts = 1 + rng() % 10;
+        for (size_t k = 0; k < bursts; ++k) {
+            cpu[i].push_back(1 + static_cast<int>(rng() % 20));
+        }
+        for (size_t k = 0; k + 1 < bursts; ++k) {
+            io[i].push_back(1 + static_cast<int>(rng() % 50));
+        }
+        burstCount += cpu[i].size() + io[i].size();
+    }
+    // Round-robin order is what FCFS and MLFQ produce under steady load; the
+    // random order models SJF picks and I/O completions scattering the queue.
+    std::vector<ProcessIndex> roundRobin(steps);
+    std::vector<ProcessIndex> scattered(steps);
+    for (size_t step = 0; step < steps; ++step) {
+        roundRobin[step] = static_cast<ProcessIndex>(step % processCount);
+        scattered[step] = static_cast<ProcessIndex>(rng() % processCount);
+    }
+
+    size_t bytesBefore = allocatedBytes;
+    size_t allocationsBefore = allocationCount;
+    std::vector<Process*> processes;
+    processes.reserve(processCount);
+    for (size_t i = 0; i < processCount; ++i) {
+        processes.push_back(new Process(static_cast<int>(i + 1), cpu[i], io[i]));
+        processes.back()->remainingCpuTime = cpu[i][0];
+    }
+    size_t pointerBytes = allocatedBytes - bytesBefore;
+    size_t pointerAllocations = allocationCount - allocationsBefore;
+
+    bytesBefore = allocatedBytes;
+    allocationsBefore = allocationCount;
+    ProcessTable table;
+    table.reserve(processCount, burstCount);
+    for (size_t i = 0; i < processCount; ++i) {
+        table.add(static_cast<int>(i + 1), cpu[i].data(), cpu[i].size(), io[i].data(), io[i].size());
+    }
+    size_t tableBytes = allocatedBytes - bytesBefore;
+    size_t tableAllocations = allocationCount - allocationsBefore;
+
+    std::printf("%zu processes, %zu bursts, %zu scheduling steps\n\n", processCount, burstCount, steps);
+    std::printf("%-18s %14s %12s\n", "layout", "bytes", "allocations");
+    std::printf("%-18s %14zu %12zu\n", "Process pointers", pointerBytes, pointerAllocations);
+    std::printf("%-18s %14zu %12zu\n\n", "ProcessTable", tableBytes, tableAllocations);
+
+    std::printf("%-18s %-12s %10s %14s\n", "layout", "order", "ns/step", "cache misses");
+    bool consistent = true;
+    const char* orderNames[] = { "round-robin", "scattered" };
+    const std::vector<ProcessIndex>* orders[] = { &roundRobin, &scattered };
+    for (int i = 0; i < 2; ++i) {
+        Timing pointers = measure(steps, [&] { return runPointers(processes, *orders[i]); });
+        Timing tabled = measure(steps, [&] { return runTable(table, *orders[i]); });
+        printTiming("Process pointers", orderNames[i], pointers);
+        printTiming("ProcessTable", orderNames[i], tabled);
+        consistent = consistent && pointers.checksum == tabled.checksum;
+    }
+    if (!consistent) {
+        std::printf("\nchecksum mismatch between layouts\n");
+        return 1;
+    }
+
+    for (Process* process : processes) {
+        delete process;
+    }
+    return 0;
+}
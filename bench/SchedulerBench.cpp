@@ -0,0 +1,177 @@
+// Throughput baseline for every single-CPU policy across synthetic workload
+// shapes and sizes. Each case streams its workload through
+// GeneratedArrivalSource, so memory holds only the live processes, and runs in
+// a child process of its own so the peak RSS reported is that case's alone.
+//
+//   cmake --build build --target scheduler_bench
+//   ./build/scheduler_bench [--max-processes N] [--filter TEXT] [--seed N]
+//
+// Sizes run from 10 processes up to --max-processes (default 10^6, up to 10^7)
+// in powers of ten. Arrival rates are set for 90% offered CPU load.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "scheduler/Engine.h"
+#include "scheduler/Policies.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SCHEDULER_BENCH_FORK 1
+#endif
+
+
+// Counts events and scheduling decisions (dispatches) without formatting anything.
+class CountingTraceSink : public TraceSink {
+public:
+    void record(const TraceEvent& event) override {
+        events++;
+        if (event.kind == TraceEventKind::RunBurst || event.kind == TraceEventKind::RunSlice) {
+            decisions++;
+        }
+    }
+
+    long long events = 0;
+    long long decisions = 0;
+};
+
+struct Scenario {
+    const char* name;
+    WorkloadSpec spec;
+};
+
+struct Policy {
+    const char* name;
+    std::function<SchedulerResult(ArrivalSource&, TraceSink&)> run;
+};
+
+struct Measurement {
+    double seconds = 0.0;
+    long long events = 0;
+    long long decisions = 0;
+    long peakRssKb = -1;
+};
+
+std::vector<Scenario> scenarios() {
+    WorkloadSpec exponential;
+    WorkloadSpec pareto;
+    pareto.distribution = BurstDistribution::Pareto;
+    WorkloadSpec cpuBound;
+    cpuBound.cpuBoundFraction = 0.8;
+    WorkloadSpec ioBound;
+    ioBound.cpuBoundFraction = 0.2;
+    return { { "exponential", exponential }, { "pareto", pareto }, { "cpu-bound", cpuBound }, { "io-bound", ioBound } };
+}
+
+std::vector<Policy> policies() {
+    return {
+        { "FCFS", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, FcfsPolicy(), t); } },
+        { "SJF", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, SjfPolicy(), t); } },
+        { "SRTF", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, SrtfPolicy(), t); } },
+        { "MLFQ", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, MlfqPolicy(MlfqConfig()), t); } },
+        { "RR", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, RoundRobinPolicy(), t); } },
+        { "CFS", [](ArrivalSource& a, TraceSink& t) { return runEngine(a, CfsPolicy(), t); } },
+    };
+}
+
+Measurement measure(const Policy& policy, const WorkloadSpec& spec, std::uint64_t seed) {
+    GeneratedArrivalSource arrivals(spec, seed);
+    CountingTraceSink sink;
+    auto start = std::chrono::steady_clock::now();
+    policy.run(arrivals, sink);
+    auto end = std::chrono::steady_clock::now();
+
+    Measurement result;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.events = sink.events;
+    result.decisions = sink.decisions;
+#ifdef SCHEDULER_BENCH_FORK
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKb = usage.ru_maxrss;
+#ifdef __APPLE__
+    result.peakRssKb /= 1024;
+#endif
+#endif
+    return result;
+}
+
+// Runs the case in a child so its peak RSS is not inflated by earlier cases.
+Measurement measureIsolated(const Policy& policy, const WorkloadSpec& spec, std::uint64_t seed) {
+#ifdef SCHEDULER_BENCH_FORK
+    int pipeEnds[2];
+    if (pipe(pipeEnds) == 0) {
+        pid_t child = fork();
+        if (child == 0) {
+            close(pipeEnds[0]);
+            Measurement result = measure(policy, spec, seed);
+            ssize_t written = write(pipeEnds[1], &result, sizeof(result));
+            _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+        }
+        close(pipeEnds[1]);
+        Measurement result;
+        bool received = child > 0 && read(pipeEnds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        close(pipeEnds[0]);
+        if (child > 0) {
+            waitpid(child, nullptr, 0);
+        }
+        if (received) {
+            return result;
+        }
+    }
+#endif
+    return measure(policy, spec, seed);
+}
+
+int main(int argc, char** argv) {
+    long long maxProcesses = 1000000;
+    std::string filter;
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--max-processes") {
+            maxProcesses = std::atoll(argv[i + 1]);
+        }
+        else if (option == "--filter") {
+            filter = argv[i + 1];
+        }
+        else if (option == "--seed") {
+            seed = static_cast<std::uint64_t>(std::atoll(argv[i + 1]));
+        }
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("%-32s %12s %14s %14s %14s %12s\n", "Benchmark", "Time ms", "Events", "Events/s", "ns/decision", "Peak RSS MB");
+    for (const Scenario& scenario : scenarios()) {
+        for (long long processes = 10; processes <= maxProcesses; processes *= 10) {
+            WorkloadSpec spec = scenario.spec;
+            spec.processes = static_cast<int>(processes);
+            spec.meanInterarrival = meanCpuDemand(spec) / 0.9;
+            for (const Policy& policy : policies()) {
+                std::string name = std::string(policy.name) + "/" + scenario.name + "/" + std::to_string(processes);
+                if (!filter.empty() && name.find(filter) == std::string::npos) {
+                    continue;
+                }
+                Measurement result = measureIsolated(policy, spec, seed);
+                std::printf("%-32s %12.3f %14lld %14.3e %14.1f %12.1f\n", name.c_str(), result.seconds * 1e3,
+                    result.events, result.events / result.seconds, result.seconds * 1e9 / result.decisions,
+                    result.peakRssKb / 1024.0);
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
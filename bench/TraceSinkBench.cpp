@@ -0,0 +1,101 @@
+// Measures how fast the MLFQ scheduler runs with each trace sink attached.
+// The text sinks write to a file rather than a terminal so the numbers show
+// formatting and hand-off cost, not the speed of the console.
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/TraceSinkBench.cpp -o trace_sink_bench
+//   ./trace_sink_bench [processCount] [scratchPrefix]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "scheduler/ArrivalSource.h"
+#include "scheduler/Process.h"
+#include "scheduler/Schedulers.h"
+#include "scheduler/TraceSink.h"
+#include "scheduler/Workloads.h"
+
+
+// Passes events through while counting them.
+class CountingTraceSink : public TraceSink {
+public:
+    explicit CountingTraceSink(TraceSink& inner) : inner(inner) {}
+
+    void record(const TraceEvent& event) override {
+        count++;
+        inner.record(event);
+    }
+
+    void flush() override { inner.flush(); }
+
+    size_t count = 0;
+
+private:
+    TraceSink& inner;
+};
+
+struct SinkTiming {
+    size_t events;
+    double simulationSeconds;   // Until the scheduler returned
+    double totalSeconds;        // Until every event reached the file
+};
+
+SinkTiming timeSink(const std::vector<Process>& prototype, TraceSink& sink) {
+    std::vector<Process> processes(prototype);
+    std::vector<Process*> pointers;
+    for (Process& process : processes) {
+        pointers.push_back(&process);
+    }
+    VectorArrivalSource arrivals(pointers);
+    CountingTraceSink counter(sink);
+
+    auto start = std::chrono::steady_clock::now();
+    mlfqScheduler(arrivals, counter);
+    auto simulated = std::chrono::steady_clock::now();
+    counter.flush();
+    auto flushed = std::chrono::steady_clock::now();
+
+    return { counter.count, std::chrono::duration<double>(simulated - start).count(),
+             std::chrono::duration<double>(flushed - start).count() };
+}
+
+void report(const char* name, const SinkTiming& timing) {
+    std::printf("%-10s %12zu %12.3f %12.3f %14.2f\n", name, timing.events, timing.simulationSeconds * 1e3,
+        timing.totalSeconds * 1e3, timing.events / timing.totalSeconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+    WorkloadSpec spec;
+    spec.processes = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string scratch = argc > 2 ? argv[2] : "trace_sink_bench";
+    std::vector<Process> workload = generateWorkload(spec, 1);
+
+    std::printf("%-10s %12s %12s %12s %14s\n", "sink", "events", "sim ms", "total ms", "Mevents/s");
+    {
+        NullTraceSink sink;
+        report("null", timeSink(workload, sink));
+    }
+    {
+        std::ofstream file(scratch + ".txt");
+        StreamTraceSink sink(file);
+        report("stream", timeSink(workload, sink));
+    }
+    {
+        std::ofstream file(scratch + ".txt");
+        AsyncTraceSink sink(file);
+        report("async", timeSink(workload, sink));
+    }
+    {
+        BinaryTraceSink sink(scratch + ".bin");
+        report("binary", timeSink(workload, sink));
+    }
+
+    std::remove((scratch + ".txt").c_str());
+    std::remove((scratch + ".bin").c_str());
+    return 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "Process.h"
+#include "Snapshot.h"
+
+
+// Feeds processes to a scheduler as simulated time reaches their
+// initialArrivalTime. Sources hand processes out in arrival order, and the
+// scheduler hands each one back through retire() once it has completed, so a
+// source can stream a workload without keeping finished processes alive.
+class ArrivalSource {
+public:
+    virtual ~ArrivalSource() = default;
+
+    // Arrival time of the next process, or INT_MAX once the source is exhausted.
+    virtual int nextArrivalTime() = 0;
+
+    // Takes the next process. Only valid while nextArrivalTime() != INT_MAX.
+    virtual Process* admit() = 0;
+
+    // Called once for every admitted process after it has completed.
+    virtual void retire(Process* process) = 0;
+
+    // False while more processes may still turn up after nextArrivalTime()
+    // has returned INT_MAX, as with live submissions to a Simulator. The
+    // engine only ends a run once its source is closed.
+    virtual bool closed() const { return true; }
+
+    // Checkpoint support. A source that can be checkpointed saves how far into
+    // its workload it has admitted, and on restore positions itself there and
+    // supplies a Process for each one the snapshot brings back to life, which
+    // it will later be handed through retire().
+    virtual void saveState(SnapshotWriter&) const {
+        throw std::runtime_error("this workload cannot be checkpointed");
+    }
+
+    virtual void loadState(SnapshotReader&) {
+        throw std::runtime_error("this workload cannot be restored from a snapshot");
+    }
+
+    virtual Process* restoreProcess(Process saved) { return new Process(std::move(saved)); }
+};
+
+// Arrival source over processes the caller already owns, such as the fixed
+// workload in main(). Processes are admitted in initialArrivalTime order,
+// keeping the caller's order among equal arrival times.
+class VectorArrivalSource : public ArrivalSource {
+public:
+    explicit VectorArrivalSource(const std::vector<Process*>& processes)
+        : pending(processes) {
+        std::stable_sort(pending.begin(), pending.end(), [](const Process* a, const Process* b) {
+            return a->initialArrivalTime < b->initialArrivalTime;
+        });
+    }
+
+    int nextArrivalTime() override {
+        return next < pending.size() ? pending[next]->initialArrivalTime : INT_MAX;
+    }
+
+    Process* admit() override { return pending[next++]; }
+
+    void retire(Process*) override {}
+
+    // Also saves the results of the processes that completed before the
+    // checkpoint, since the caller reads them off its own objects.
+    void saveState(SnapshotWriter& out) const override {
+        out.writeSize(next);
+        size_t completed = 0;
+        for (size_t i = 0; i < next; ++i) {
+            completed += pending[i]->isCompleted ? 1 : 0;
+        }
+        out.writeSize(completed);
+        for (size_t i = 0; i < next; ++i) {
+            if (pending[i]->isCompleted) {
+                out.writeProcess(*pending[i]);
+            }
+        }
+    }
+
+    void loadState(SnapshotReader& in) override {
+        std::uint64_t admitted = in.readSize();
+        if (admitted > pending.size()) {
+            throw std::runtime_error("snapshot was taken on a different workload");
+        }
+        next = static_cast<size_t>(admitted);
+        for (std::uint64_t completed = in.readSize(); completed > 0; --completed) {
+            restoreProcess(in.readProcess());
+        }
+    }
+
+    // Copies the saved state onto the caller's process with the same pid.
+    Process* restoreProcess(Process saved) override {
+        if (byPid.empty()) {
+            for (Process* process : pending) {
+                byPid[process->pid] = process;
+            }
+        }
+        auto found = byPid.find(saved.pid);
+        if (found == byPid.end()) {
+            throw std::runtime_error("snapshot was taken on a different workload");
+        }
+        *found->second = std::move(saved);
+        return found->second;
+    }
+
+private:
+    std::vector<Process*> pending;
+    size_t next = 0;
+    std::unordered_map<int, Process*> byPid;
+};
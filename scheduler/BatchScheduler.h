@@ -0,0 +1,515 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "Engine.h"
+#include "Policies.h"
+#include "Process.h"
+#include "TraceSink.h"
+
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__AVX512F__))
+#include <immintrin.h>
+#endif
+
+
+// Scenarios simulated side by side: one 32-bit lane of the widest vector
+// register the target has.
+#if defined(__AVX512F__)
+static const int BatchLanes = 16;
+#elif defined(__AVX2__)
+static const int BatchLanes = 8;
+#else
+static const int BatchLanes = 4;
+#endif
+
+#if defined(__GNUC__)
+// One int per lane. GCC and Clang compile the elementwise operators of a
+// vector type to SIMD instructions of whatever width the target has, split
+// into narrower ones when it has less. Comparisons give masks: lanes of all
+// ones or all zeros.
+typedef int LaneInts __attribute__((vector_size(BatchLanes * sizeof(int))));
+
+inline LaneInts broadcast(int value) {
+    LaneInts lanes = {};
+    return lanes + value;
+}
+#else
+// The same for compilers without vector types, as plain loops over the lanes.
+struct LaneInts {
+    int v[BatchLanes];
+
+    int& operator[](int i) { return v[i]; }
+    int operator[](int i) const { return v[i]; }
+
+    template <typename Operation>
+    static LaneInts apply(const LaneInts& a, const LaneInts& b, Operation operation) {
+        LaneInts r;
+        for (int i = 0; i < BatchLanes; ++i) {
+            r.v[i] = operation(a.v[i], b.v[i]);
+        }
+        return r;
+    }
+
+    friend LaneInts operator+(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x + y; }); }
+    friend LaneInts operator-(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x - y; }); }
+    friend LaneInts operator*(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x * y; }); }
+    friend LaneInts operator&(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x & y; }); }
+    friend LaneInts operator|(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x | y; }); }
+    friend LaneInts operator<(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x < y ? -1 : 0; }); }
+    friend LaneInts operator<=(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x <= y ? -1 : 0; }); }
+    friend LaneInts operator==(LaneInts a, LaneInts b) { return apply(a, b, [](int x, int y) { return x == y ? -1 : 0; }); }
+    friend LaneInts operator~(LaneInts a) { return apply(a, a, [](int x, int) { return ~x; }); }
+};
+
+inline LaneInts broadcast(int value) {
+    LaneInts lanes;
+    for (int i = 0; i < BatchLanes; ++i) {
+        lanes.v[i] = value;
+    }
+    return lanes;
+}
+#endif
+
+// a where the mask is set, b elsewhere
+inline LaneInts select(LaneInts mask, LaneInts a, LaneInts b) {
+#if defined(__GNUC__)
+    return mask ? a : b;
+#else
+    return (mask & a) | (~mask & b);
+#endif
+}
+
+inline LaneInts minLanes(LaneInts a, LaneInts b) { return select(a < b, a, b); }
+inline LaneInts maxLanes(LaneInts a, LaneInts b) { return select(b < a, a, b); }
+
+inline bool any(LaneInts mask) {
+#if defined(__GNUC__) && defined(__AVX512F__)
+    return _mm512_test_epi32_mask((__m512i)mask, (__m512i)mask) != 0;
+#elif defined(__GNUC__) && defined(__AVX2__)
+    return !_mm256_testz_si256((__m256i)mask, (__m256i)mask);
+#else
+    int bits = 0;
+    for (int i = 0; i < BatchLanes; ++i) {
+        bits |= mask[i];
+    }
+    return bits != 0;
+#endif
+}
+
+inline LaneInts laneNumbers() {
+    static const int numbers[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    LaneInts lanes;
+    std::memcpy(&lanes, numbers, sizeof(lanes));
+    return lanes;
+}
+
+// Reads column[row[i]] of every lane i from a row-major table with one
+// column per lane. Rows must be in range in every lane.
+inline LaneInts gather(const int* table, LaneInts row) {
+    LaneInts index = row * broadcast(BatchLanes) + laneNumbers();
+#if defined(__GNUC__) && defined(__AVX512F__)
+    __m512i values = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, (__m512i)index, table, 4);
+    return (LaneInts)values;
+#elif defined(__GNUC__) && defined(__AVX2__)
+    __m256i values = _mm256_i32gather_epi32(table, (__m256i)index, 4);
+    return (LaneInts)values;
+#else
+    LaneInts values;
+    for (int i = 0; i < BatchLanes; ++i) {
+        values[i] = table[index[i]];
+    }
+    return values;
+#endif
+}
+
+// Writes value[i] to column[row[i]] of the lanes in `mask`.
+inline void scatter(int* table, LaneInts row, LaneInts mask, LaneInts value) {
+    LaneInts index = row * broadcast(BatchLanes) + laneNumbers();
+#if defined(__GNUC__) && defined(__AVX512F__)
+    __mmask16 lanes = _mm512_test_epi32_mask((__m512i)mask, (__m512i)mask);
+    _mm512_mask_i32scatter_epi32(table, lanes, (__m512i)index, (__m512i)value, 4);
+#elif defined(__GNUC__) && defined(__AVX2__)
+    for (unsigned lanes = _mm256_movemask_ps((__m256)mask); lanes != 0; lanes &= lanes - 1) {
+        int i = __builtin_ctz(lanes);
+        table[index[i]] = value[i];
+    }
+#else
+    // Every lane writes its own column, so writing the old value back in the
+    // lanes outside the mask saves a branch per lane
+    LaneInts merged = select(mask, value, gather(table, row));
+    for (int i = 0; i < BatchLanes; ++i) {
+        table[index[i]] = merged[i];
+    }
+#endif
+}
+
+// Lockstep FCFS / round-robin simulation of workloads of up to MaxSlots
+// processes each, BatchLanes at a time. Slots are a workload's processes in admission
+// order, and every per-process field is a table with a row per slot and a
+// column per lane, read and written with gathers and scatters since each lane
+// runs a different process. Each lane keeps its ready queue as a ring of
+// slots and tracks its next I/O completion, so an I/O drain only scans the
+// slots when one is due. It follows Engine step for step, with the same
+// admission and drain order and the same arithmetic, so every result comes
+// out bit-identical.
+class BatchKernel {
+public:
+    static const int MaxSlots = 16;
+
+    // quantum 0 runs every burst to completion (FCFS). Workloads may have up
+    // to `slots` processes and `bursts` CPU and I/O bursts in all.
+    BatchKernel(int quantum, int slots, size_t bursts)
+        : quantum(quantum), slots(slots), arena(std::max<size_t>(bursts, 1) * BatchLanes, 0) {
+        std::fill(std::begin(initialArrival), std::end(initialArrival), INT_MAX);
+        std::fill(std::begin(ioDone), std::end(ioDone), INT_MAX);
+    }
+
+    // Runs every workload and stores its result at the same index of
+    // `results`. A lane takes the next workload as soon as its last one ends,
+    // so lanes only idle once the queue is empty.
+    void run(std::vector<Process>* const* workloads, size_t count, SchedulerResult* results) {
+        size_t next = 0;
+        for (int lane = 0; lane < BatchLanes && next < count; ++lane) {
+            load(lane, next, *workloads[next]);
+            next++;
+        }
+        LaneInts never = broadcast(INT_MAX);
+        while (any(active)) {
+            admitArrivals(active);
+            drainIo(active);
+
+            LaneInts idle = active & (head == tail);
+            if (any(idle)) {
+                // Nothing ready: jump to the next I/O completion or arrival, or end
+                LaneInts following = minLanes(nextArrival, nextIo);
+                LaneInts ended = idle & (following == never);
+                time = select(idle & ~ended, following, time);
+                if (any(ended)) {
+                    for (int lane = 0; lane < BatchLanes; ++lane) {
+                        if (ended[lane] == 0) {
+                            continue;
+                        }
+                        results[current[lane]] = result(lane, *workloads[current[lane]]);
+                        active[lane] = 0;
+                        if (next < count) {
+                            load(lane, next, *workloads[next]);
+                            next++;
+                        }
+                    }
+                }
+            }
+
+            LaneInts running = active & ~idle;
+            if (any(running)) {
+                runSegment(running);
+            }
+        }
+    }
+
+private:
+    // Replaces the lane's workload with `workload`, starting at time 0
+    void load(int lane, size_t index, const std::vector<Process>& workload) {
+        current[lane] = index;
+        count[lane] = static_cast<int>(workload.size());
+        admissionOrder(workload, order[lane]);
+        int row = 0;
+        for (int s = 0; s < MaxSlots; ++s) {
+            int cell = s * BatchLanes + lane;
+            initialArrival[cell] = INT_MAX;
+            ioDone[cell] = INT_MAX;
+            completed[cell] = 0;
+            if (s >= count[lane]) {
+                continue;
+            }
+            const Process& process = workload[order[lane][s]];
+            initialArrival[cell] = process.initialArrivalTime;
+            burstIndex[cell] = process.currentBurstIndex;
+            waiting[cell] = process.waitingTime;
+            response[cell] = process.responseTime;
+            longest[cell] = process.longestWait;
+            cpuOffset[cell] = row;
+            cpuCount[cell] = static_cast<int>(process.cpuBursts.size());
+            for (int burst : process.cpuBursts) {
+                arena[static_cast<size_t>(row++) * BatchLanes + lane] = burst;
+            }
+            ioOffset[cell] = row;
+            ioCount[cell] = static_cast<int>(process.ioTimes.size());
+            for (int io : process.ioTimes) {
+                arena[static_cast<size_t>(row++) * BatchLanes + lane] = io;
+            }
+        }
+        active[lane] = -1;
+        time[lane] = 0;
+        cpuTime[lane] = 0;
+        admitted[lane] = 0;
+        nextArrival[lane] = initialArrival[lane];
+        nextIo[lane] = INT_MAX;
+        head[lane] = 0;
+        tail[lane] = 0;
+        ioSerial[lane] = 0;
+    }
+
+    // Copies the lane's results back into its workload
+    SchedulerResult result(int lane, std::vector<Process>& workload) const {
+        for (int s = 0; s < count[lane]; ++s) {
+            Process& process = workload[order[lane][s]];
+            int cell = s * BatchLanes + lane;
+            process.waitingTime = waiting[cell];
+            process.turnaroundTime = turnaround[cell];
+            process.responseTime = response[cell];
+            process.longestWait = longest[cell];
+            process.isCompleted = completed[cell] != 0;
+        }
+        int totalCpuTime = cpuTime[lane];
+        int currentTime = time[lane];
+        double cpuUtilization = (static_cast<double>(totalCpuTime) / currentTime) * 100.0;
+        return { totalCpuTime, currentTime, cpuUtilization };
+    }
+
+private:
+    // Positions in the workload in the order VectorArrivalSource admits them
+    static void admissionOrder(const std::vector<Process>& workload, std::vector<int>& positions) {
+        // Insertion sort: stable, and with no buffer to allocate for a few processes
+        positions.resize(workload.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            size_t j = i;
+            for (; j > 0 && workload[i].initialArrivalTime < workload[positions[j - 1]].initialArrivalTime; --j) {
+                positions[j] = positions[j - 1];
+            }
+            positions[j] = static_cast<int>(i);
+        }
+    }
+
+    static LaneInts ones(LaneInts mask) { return mask & broadcast(1); }
+
+    // Burst table rows, with the lanes outside `mask` reading row 0
+    LaneInts burst(LaneInts row, LaneInts mask) const { return gather(arena.data(), row & mask); }
+
+    void enqueue(LaneInts slot, LaneInts mask) {
+        scatter(ring, tail & broadcast(MaxSlots - 1), mask, slot);
+        tail = tail + ones(mask);
+    }
+
+    void admitArrivals(LaneInts lanes) {
+        for (;;) {
+            LaneInts due = lanes & (nextArrival <= time);
+            if (!any(due)) {
+                return;
+            }
+            LaneInts slot = admitted & due;
+            LaneInts index = gather(burstIndex, slot);
+            scatter(remaining, slot, due, burst(gather(cpuOffset, slot) + index, due));
+            scatter(arrivalTime, slot, due, nextArrival);
+            enqueue(slot, due);
+            admitted = admitted + ones(due);
+            LaneInts following = minLanes(admitted, broadcast(MaxSlots - 1));
+            LaneInts arrival = select(admitted < broadcast(MaxSlots), gather(initialArrival, following), broadcast(INT_MAX));
+            nextArrival = select(due, arrival, nextArrival);
+        }
+    }
+
+    // Completions due by now, one at a time in the order they started I/O
+    void drainIo(LaneInts lanes) {
+        LaneInts never = broadcast(INT_MAX);
+        while (any(lanes & (nextIo <= time))) {
+            // The earliest started of the due completions, how many are due,
+            // and the soonest of the rest
+            LaneInts first = never;
+            LaneInts slot = broadcast(0);
+            LaneInts dueCount = broadcast(0);
+            LaneInts soonest = never;
+            for (int s = 0; s < slots; ++s) {
+                LaneInts done = load(ioDone, s);
+                LaneInts seq = load(ioSeq, s);
+                LaneInts isDue = done <= time;
+                LaneInts earlier = isDue & (seq < first);
+                first = select(earlier, seq, first);
+                slot = select(earlier, broadcast(s), slot);
+                dueCount = dueCount - isDue;
+                soonest = minLanes(soonest, select(isDue, never, done));
+            }
+            LaneInts due = lanes & ~(first == never);
+            // Lanes left with a due completion drain it on the next pass
+            LaneInts undrained = dueCount - ones(due);
+            nextIo = select(broadcast(0) < undrained, time, soonest);
+            if (!any(due)) {
+                return;
+            }
+            LaneInts completion = gather(ioDone, slot);
+            scatter(ioDone, slot, due, never);
+            LaneInts index = gather(burstIndex, slot) + broadcast(1);
+            scatter(burstIndex, slot, due, index);
+            LaneInts more = due & (index < gather(cpuCount, slot));
+            scatter(remaining, slot, more, burst(gather(cpuOffset, slot) + index, more));
+            scatter(arrivalTime, slot, more, completion);
+            enqueue(slot, more);
+            complete(slot, due & ~more, completion);
+        }
+    }
+
+    void complete(LaneInts slot, LaneInts mask, LaneInts completion) {
+        scatter(turnaround, slot, mask, completion - gather(initialArrival, slot));
+        scatter(completed, slot, mask, broadcast(-1));
+    }
+
+    void runSegment(LaneInts lanes) {
+        // Dispatch the front of the ready queue
+        LaneInts slot = gather(ring, head & broadcast(MaxSlots - 1)) & lanes;
+        head = head + ones(lanes);
+        LaneInts first = lanes & (gather(response, slot) == broadcast(-1));
+        scatter(response, slot, first, time - gather(initialArrival, slot));
+        LaneInts waited = time - gather(arrivalTime, slot);
+        scatter(waiting, slot, lanes, gather(waiting, slot) + waited);
+        scatter(longest, slot, lanes, maxLanes(gather(longest, slot), waited));
+
+        LaneInts left = gather(remaining, slot);
+        LaneInts executed = (quantum > 0 ? minLanes(left, broadcast(quantum)) : left) & lanes;
+        time = time + executed;
+        cpuTime = cpuTime + executed;
+        left = left - executed;
+        scatter(remaining, slot, lanes, left);
+
+        LaneInts burstDone = lanes & (left == broadcast(0));
+        LaneInts index = gather(burstIndex, slot);
+        LaneInts blocks = burstDone & (index < gather(ioCount, slot));
+        if (any(blocks)) {
+            LaneInts done = time + burst(gather(ioOffset, slot) + index, blocks);
+            scatter(ioDone, slot, blocks, done);
+            scatter(ioSeq, slot, blocks, ioSerial);
+            ioSerial = ioSerial + ones(blocks);
+            scatter(arrivalTime, slot, blocks, time);
+            nextIo = select(blocks, minLanes(nextIo, done), nextIo);
+        }
+        complete(slot, burstDone & ~blocks, time);
+
+        // Quantum expired: requeue behind everything that became ready meanwhile
+        LaneInts expired = lanes & ~burstDone;
+        if (any(expired)) {
+            admitArrivals(expired);
+            drainIo(expired);
+            scatter(arrivalTime, slot, expired, time);
+            enqueue(slot, expired);
+        }
+    }
+
+    static LaneInts load(const int* table, int row) {
+        LaneInts values;
+        std::memcpy(&values, table + row * BatchLanes, sizeof(values));
+        return values;
+    }
+
+    int quantum;
+    int slots;
+    size_t current[BatchLanes] = {};  // Index of the workload each lane is running
+    int count[BatchLanes] = {};
+    std::vector<int> order[BatchLanes];
+    std::vector<int> arena;   // Every burst, a row per burst and a column per lane
+
+    LaneInts active = {};
+    LaneInts time = {};
+    LaneInts cpuTime = {};
+    LaneInts admitted = {};
+    LaneInts nextArrival = {};
+    LaneInts nextIo = {};
+    LaneInts head = {};             // Ready ring: slots queued at [head, tail)
+    LaneInts tail = {};
+    LaneInts ioSerial = {};
+
+    // Tables of MaxSlots rows by BatchLanes columns
+    int ring[MaxSlots * BatchLanes] = {};
+    int initialArrival[MaxSlots * BatchLanes];
+    int cpuOffset[MaxSlots * BatchLanes] = {};
+    int cpuCount[MaxSlots * BatchLanes] = {};
+    int ioOffset[MaxSlots * BatchLanes] = {};
+    int ioCount[MaxSlots * BatchLanes] = {};
+    int burstIndex[MaxSlots * BatchLanes] = {};
+    int remaining[MaxSlots * BatchLanes] = {};
+    int arrivalTime[MaxSlots * BatchLanes] = {};
+    int ioDone[MaxSlots * BatchLanes];     // I/O completion time, INT_MAX when not blocked
+    int ioSeq[MaxSlots * BatchLanes] = {};
+    int waiting[MaxSlots * BatchLanes] = {};
+    int response[MaxSlots * BatchLanes] = {};
+    int longest[MaxSlots * BatchLanes] = {};
+    int turnaround[MaxSlots * BatchLanes] = {};
+    int completed[MaxSlots * BatchLanes] = {};
+};
+
+// Runs many small workloads under one policy, BatchLanes at a time in
+// lockstep, for Monte Carlo sweeps where per-simulation overhead would
+// dominate. Results match schedulerFunction (FCFS) or runEngine with the
+// RoundRobinPolicy bit for bit: each process gets the waitingTime,
+// turnaroundTime, responseTime, longestWait and isCompleted the engine would
+// give it, and the result for each workload is returned in order. Workloads
+// of more than BatchKernel::MaxSlots processes run through the engine.
+// A quantum of 0 is FCFS.
+inline std::vector<SchedulerResult> runBatch(std::vector<std::vector<Process>>& workloads, int quantum) {
+    if (quantum < 0) {
+        throw std::invalid_argument("round robin needs a positive quantum");
+    }
+    for (const std::vector<Process>& workload : workloads) {
+        for (const Process& process : workload) {
+            if (process.currentBurstIndex < 0 || process.currentBurstIndex >= static_cast<int>(process.cpuBursts.size())) {
+                throw std::invalid_argument("process " + std::to_string(process.pid) + " has no CPU burst left to run");
+            }
+        }
+    }
+
+    std::vector<SchedulerResult> results(workloads.size());
+    std::vector<size_t> batched;
+    for (size_t w = 0; w < workloads.size(); ++w) {
+        if (workloads[w].size() <= static_cast<size_t>(BatchKernel::MaxSlots)) {
+            batched.push_back(w);
+            continue;
+        }
+        std::vector<Process*> pointers;
+        for (Process& process : workloads[w]) {
+            pointers.push_back(&process);
+        }
+        VectorArrivalSource arrivals(pointers);
+        NullTraceSink discard;
+        results[w] = quantum > 0 ? runEngine(arrivals, RoundRobinPolicy(quantum), discard)
+                                 : runEngine(arrivals, FcfsPolicy(), discard);
+    }
+
+    if (batched.empty()) {
+        return results;
+    }
+    int slots = 0;
+    size_t bursts = 0;
+    std::vector<std::vector<Process>*> queue;
+    for (size_t w : batched) {
+        slots = std::max(slots, static_cast<int>(workloads[w].size()));
+        size_t total = 0;
+        for (const Process& process : workloads[w]) {
+            total += process.cpuBursts.size() + process.ioTimes.size();
+        }
+        bursts = std::max(bursts, total);
+        queue.push_back(&workloads[w]);
+    }
+    std::vector<SchedulerResult> batchResults(batched.size());
+    BatchKernel kernel(quantum, slots, bursts);
+    kernel.run(queue.data(), queue.size(), batchResults.data());
+    for (size_t i = 0; i < batched.size(); ++i) {
+        results[batched[i]] = batchResults[i];
+    }
+    return results;
+}
+
+inline std::vector<SchedulerResult> runBatch(std::vector<std::vector<Process>>& workloads, FcfsPolicy) {
+    return runBatch(workloads, 0);
+}
+
+inline std::vector<SchedulerResult> runBatch(std::vector<std::vector<Process>>& workloads, RoundRobinPolicy policy) {
+    if (policy.quantumLength() <= 0) {
+        throw std::invalid_argument("round robin needs a positive quantum");
+    }
+    return runBatch(workloads, policy.quantumLength());
+}
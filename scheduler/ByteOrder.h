@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+
+// The binary file formats store their integers little-endian whatever the
+// host's byte order, so a file written on one machine reads the same on any
+// other. These assemble and split words a byte at a time, which compilers
+// turn into a plain load or store on little-endian targets.
+
+inline std::uint32_t loadLittle32(const char* bytes) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes);
+    return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8
+        | static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+inline std::uint64_t loadLittle64(const char* bytes) {
+    return static_cast<std::uint64_t>(loadLittle32(bytes)) | static_cast<std::uint64_t>(loadLittle32(bytes + 4)) << 32;
+}
+
+inline void storeLittle32(char* bytes, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+inline void storeLittle64(char* bytes, std::uint64_t value) {
+    storeLittle32(bytes, static_cast<std::uint32_t>(value));
+    storeLittle32(bytes + 4, static_cast<std::uint32_t>(value >> 32));
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "CostModel.h"
+#include "Engine.h"
+#include "Policies.h"
+#include "Process.h"
+#include "Schedulers.h"
+#include "ThreadPool.h"
+#include "TraceFile.h"
+#include "TraceSink.h"
+
+
+// A named scheduler configuration to include in a comparison.
+struct PolicyVariant {
+    std::string name;
+    std::function<SchedulerResult(ArrivalSource&, TraceSink&)> run;
+};
+
+// Runs `policy` on the engine, charging dispatches under `costs`.
+template <typename Policy>
+PolicyVariant policyVariant(std::string name, Policy policy, const CostModel& costs) {
+    return { std::move(name), [policy, costs](ArrivalSource& arrivals, TraceSink& trace) {
+        Engine<Policy> engine(arrivals, policy, trace);
+        engine.setCostModel(costs);
+        return engine.run();
+    } };
+}
+
+inline std::vector<PolicyVariant> standardPolicies(const CostModel& costs = CostModel()) {
+    return {
+        policyVariant("FCFS", FcfsPolicy(), costs),
+        policyVariant("SJF", SjfPolicy(), costs),
+        policyVariant("SRTF", SrtfPolicy(), costs),
+        policyVariant("MLFQ", MlfqPolicy(MlfqConfig()), costs),
+        policyVariant("RR", RoundRobinPolicy(), costs),
+        policyVariant("Priority", PriorityPolicy(), costs),
+        policyVariant("Lottery", LotteryPolicy(), costs),
+        policyVariant("CFS", CfsPolicy(), costs),
+    };
+}
+
+// Creates a fresh, independent copy of the workload for one run.
+using WorkloadFactory = std::function<std::unique_ptr<ArrivalSource>()>;
+
+// Arrival source owning its own copy of a workload, so concurrent runs never
+// share mutable Process state.
+class ClonedWorkload : public ArrivalSource {
+public:
+    explicit ClonedWorkload(const std::vector<Process>& prototype)
+        : processes(prototype) {
+        std::vector<Process*> pointers;
+        pointers.reserve(processes.size());
+        for (Process& process : processes) {
+            pointers.push_back(&process);
+        }
+        arrivals.reset(new VectorArrivalSource(pointers));
+    }
+
+    int nextArrivalTime() override { return arrivals->nextArrivalTime(); }
+    Process* admit() override { return arrivals->admit(); }
+    void retire(Process* process) override { arrivals->retire(process); }
+
+private:
+    std::vector<Process> processes;
+    std::unique_ptr<VectorArrivalSource> arrivals;
+};
+
+inline WorkloadFactory cloneWorkload(std::vector<Process> prototype) {
+    auto shared = std::make_shared<const std::vector<Process>>(std::move(prototype));
+    return [shared] { return std::unique_ptr<ArrivalSource>(new ClonedWorkload(*shared)); };
+}
+
+// Every run maps the trace on its own; the pages are shared through the page cache.
+inline WorkloadFactory traceWorkload(const std::string& path) {
+    return [path] { return std::unique_ptr<ArrivalSource>(new TraceReader(path)); };
+}
+
+// Aggregate results of one policy over one workload.
+struct ComparisonRow {
+    std::string name;
+    SchedulerResult result;
+    long long completed = 0;
+    long long totalWaiting = 0;
+    long long totalTurnaround = 0;
+    long long totalResponse = 0;
+    std::string error;
+
+    double average(long long total) const {
+        return completed > 0 ? static_cast<double>(total) / completed : 0.0;
+    }
+};
+
+// Forwards to another source and folds each retiring process into a row.
+class MetricsArrivalSource : public ArrivalSource {
+public:
+    MetricsArrivalSource(ArrivalSource& inner, ComparisonRow& row)
+        : inner(inner), row(row) {}
+
+    int nextArrivalTime() override { return inner.nextArrivalTime(); }
+    Process* admit() override { return inner.admit(); }
+
+    void retire(Process* process) override {
+        row.completed++;
+        row.totalWaiting += process->waitingTime;
+        row.totalTurnaround += process->turnaroundTime;
+        row.totalResponse += process->responseTime;
+        inner.retire(process);
+    }
+
+private:
+    ArrivalSource& inner;
+    ComparisonRow& row;
+};
+
+// Runs every policy on its own copy of the workload, concurrently on the pool.
+// Rows come back in the same order as `policies`.
+inline std::vector<ComparisonRow> comparePolicies(const std::vector<PolicyVariant>& policies,
+                                                  const WorkloadFactory& makeWorkload, ThreadPool& pool) {
+    std::vector<ComparisonRow> rows(policies.size());
+    for (size_t i = 0; i < policies.size(); ++i) {
+        rows[i].name = policies[i].name;
+        pool.submit([&policies, &makeWorkload, &rows, i] {
+            ComparisonRow& row = rows[i];
+            try {
+                std::unique_ptr<ArrivalSource> workload = makeWorkload();
+                MetricsArrivalSource arrivals(*workload, row);
+                NullTraceSink discard;
+                row.result = policies[i].run(arrivals, discard);
+            }
+            catch (const std::exception& error) {
+                row.error = error.what();
+            }
+        });
+    }
+    pool.wait();
+    return rows;
+}
+
+inline void printComparison(const std::vector<ComparisonRow>& rows, std::ostream& out) {
+    // Dispatch overhead gets a column once a cost model charges any
+    bool overhead = std::any_of(rows.begin(), rows.end(), [](const ComparisonRow& row) {
+        return row.error.empty() && row.result.overheadTime > 0;
+    });
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %10s %12s %12s %12s %10s %10s",
+        "Policy", "Processes", "Avg Wait", "Avg Turn", "Avg Resp", "CPU Util", "Makespan");
+    out << line << (overhead ? "   Overhead\n" : "\n");
+    for (const ComparisonRow& row : rows) {
+        if (!row.error.empty()) {
+            out << row.name << ": " << row.error << "\n";
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-16s %10lld %12.2f %12.2f %12.2f %9.2f%% %10lld",
+            row.name.c_str(), row.completed, row.average(row.totalWaiting), row.average(row.totalTurnaround),
+            row.average(row.totalResponse), row.result.cpuUtilization, row.result.totalSimulationTime);
+        out << line;
+        if (overhead) {
+            double share = row.result.totalSimulationTime > 0
+                ? 100.0 * row.result.overheadTime / row.result.totalSimulationTime : 0.0;
+            std::snprintf(line, sizeof(line), " %9.2f%%", share);
+            out << line;
+        }
+        out << "\n";
+    }
+}
+
+// Splits `capacity` units of CPU time into useful work, dispatch overhead and idle time.
+inline void printTimeBreakdown(long long useful, long long overhead, long long capacity, std::ostream& out) {
+    auto share = [capacity](long long part) { return capacity > 0 ? 100.0 * part / capacity : 0.0; };
+    long long idle = capacity - useful - overhead;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Useful work %lld (%.2f%%), switch overhead %lld (%.2f%%), idle %lld (%.2f%%)\n",
+        useful, share(useful), overhead, share(overhead), idle, share(idle));
+    out << line;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Process.h"
+
+
+// Time a CPU spends getting a process onto it rather than running it. Every
+// cost defaults to zero, which is the free switching the schedulers always
+// assumed. A dispatch pays the sum of
+//
+//   switchCost     when the process is not the one the CPU ran last
+//   coldCost       when the process's cache is cold: it never ran, it last ran
+//                  on another core, or it has been off the CPU for at least
+//                  coldAfter time units (0: never cold from time alone)
+//   dispatchCost   by queue level, level 1 first; deeper levels pay the last
+//                  entry, and an empty list costs nothing
+//
+// The overhead runs before the process does and cannot be preempted. It
+// counts towards the process's waiting and response times and the run's
+// makespan, but not towards CPU time, so utilization only credits useful work.
+struct CostModel {
+    int switchCost = 0;
+    int coldCost = 0;
+    int coldAfter = 0;
+    std::vector<int> dispatchCost;
+
+    bool free() const {
+        return switchCost == 0 && coldCost == 0
+            && std::all_of(dispatchCost.begin(), dispatchCost.end(), [](int cost) { return cost == 0; });
+    }
+
+    bool valid() const {
+        return switchCost >= 0 && coldCost >= 0 && coldAfter >= 0
+            && std::all_of(dispatchCost.begin(), dispatchCost.end(), [](int cost) { return cost >= 0; });
+    }
+
+    bool cold(const Process& process, int core, int now) const {
+        return process.lastRanAt < 0 || (process.lastCore != -1 && process.lastCore != core)
+            || (coldAfter > 0 && now - process.lastRanAt >= coldAfter);
+    }
+
+    // Overhead of dispatching `process` at `now` on a core that last ran `previousPid`.
+    int overhead(const Process& process, int previousPid, int core, int now) const {
+        int cost = process.pid != previousPid ? switchCost : 0;
+        if (coldCost > 0 && cold(process, core, now)) {
+            cost += coldCost;
+        }
+        if (!dispatchCost.empty()) {
+            size_t level = static_cast<size_t>(std::max(process.queueLevel, 1)) - 1;
+            cost += dispatchCost[std::min(level, dispatchCost.size() - 1)];
+        }
+        return cost;
+    }
+};
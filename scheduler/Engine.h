@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "ArrivalSource.h"
+#include "CostModel.h"
+#include "IoEventQueue.h"
+#include "Process.h"
+#include "Snapshot.h"
+#include "Statistics.h"
+#include "TraceSink.h"
+
+
+// Whole-run figures returned by every scheduler. Per-process results stay on
+// the Process objects and are reported as each one retires.
+struct SchedulerResult {
+    long long totalCpuTime = 0;          // Time the CPU spent running bursts
+    long long totalSimulationTime = 0;   // Time at which the last process finished
+    double cpuUtilization = 0.0;         // Percentage of totalSimulationTime spent busy
+    long long overheadTime = 0;          // Time the CPU spent switching processes in (see CostModel)
+};
+
+// Single-CPU simulation loop shared by every policy (see Policies.h). The
+// engine owns the clock, arrivals, I/O and accounting; the policy only orders
+// the ready processes and sizes time slices. Accounting is the same for every
+// policy:
+//
+//   waiting time     sum of the time spent ready but not running
+//   response time    first dispatch - initialArrivalTime
+//   turnaround time  completion - initialArrivalTime
+//
+// Dispatches are free unless setCostModel() says otherwise; a dispatch's
+// overhead counts as waiting, and a dispatch happens when it is over.
+//
+// The clock is an int like every other simulated time; a step that would move
+// it, or an I/O completion, to INT_MAX or beyond throws std::overflow_error
+// (see simulatedTime()).
+//
+// Statistics receives the hooks of NoStatistics (see Statistics.h); pass a
+// reference type such as SimulationStatistics& to collect into an object the
+// caller owns.
+template <typename Policy, typename Statistics = NoStatistics>
+class Engine {
+public:
+    Engine(ArrivalSource& arrivals, Policy policy, TraceSink& trace, Statistics statistics = Statistics())
+        : arrivals(arrivals), policy(std::move(policy)), trace(trace), statistics(statistics),
+          nextArrivalTime(arrivals.nextArrivalTime()) {}
+
+    // Advances to the next scheduling decision: a dispatch, the end of a run
+    // segment, a preemption or a jump over idle time. Returns false once every
+    // process has completed.
+    bool step() {
+        if (finished) {
+            return false;
+        }
+        if (stopped && resume()) {
+            return true;
+        }
+        policy.onClock(currentTime);
+
+        // Admit new arrivals, then move processes that have completed I/O back to the ready queue
+        admitArrivals();
+        drainIo();
+
+        if (running == nullptr) {
+            if (policy.empty()) {
+                // Nothing is ready; advance time to the next I/O completion or arrival
+                int nextEventTime = std::min(ioQueue.nextCompletionTime(), nextArrivalTime);
+                if (nextEventTime == INT_MAX) {
+                    // An open source may still submit more work; stay idle until it does
+                    if (arrivals.closed()) {
+                        finish();
+                    }
+                    return false;
+                }
+                currentTime = nextEventTime;
+                return true;
+            }
+            dispatch(policy.pickNext());
+        }
+        else if (Process* preemptor = policy.preemptor(*running)) {
+            trace.record({ currentTime, running->pid, TraceEventKind::PreemptedBy,
+                           running->remainingCpuTime, preemptor->pid });
+            running->arrivalTime = currentTime;
+            statistics.readied(currentTime);
+            dispatch(policy.swapRunning(running));
+        }
+
+        runSegment();
+        return true;
+    }
+
+    SchedulerResult run() {
+        while (step()) {
+        }
+        return result();
+    }
+
+    SchedulerResult result() const {
+        double cpuUtilization = (static_cast<double>(totalCpuTime) / currentTime) * 100.0;
+        return { totalCpuTime, currentTime, cpuUtilization, overheadTime };
+    }
+
+    int now() const { return currentTime; }
+    bool done() const { return finished; }
+    Process* runningProcess() const { return running; }
+    int lastDispatched() const { return lastPid; }
+
+    // True between steps when no process is running, ready or blocked on I/O.
+    bool idle() const { return running == nullptr && policy.empty() && ioQueue.empty(); }
+    Policy& schedulingPolicy() { return policy; }
+
+    // Time at which the next step() has something to do, or INT_MAX when
+    // nothing will happen until more processes arrive.
+    int nextDecisionTime() const {
+        if (running != nullptr || !policy.empty()) {
+            return currentTime;
+        }
+        return std::max(currentTime, std::min(ioQueue.nextCompletionTime(), nextArrivalTime));
+    }
+
+    // Moves an idle clock forward to `time` if nothing happens before then.
+    void idleUntil(int time) {
+        if (!finished && time > currentTime && nextDecisionTime() > time) {
+            currentTime = time;
+        }
+    }
+
+    // Charges every dispatch from now on under `model`.
+    void setCostModel(CostModel model) {
+        if (!model.valid()) {
+            throw std::invalid_argument("switch, cold-cache and dispatch costs must not be negative");
+        }
+        costs = std::move(model);
+        chargesOverhead = !costs.free();
+    }
+
+    // Picks up processes the source gained since the engine last looked.
+    void refreshArrivals() { nextArrivalTime = arrivals.nextArrivalTime(); }
+
+    // Stops any run segment at `time` so a caller can add arrivals there. The
+    // next step() resumes the segment without a new dispatch, so a run paused
+    // at a horizon traces exactly as one that was not.
+    void setHorizon(int time) { horizon = time; }
+
+    // Writes everything needed to carry on from this point between two steps:
+    // the clock, each live process wherever it is (running, blocked on I/O or
+    // ready, in queue order) and the arrival source's position. Statistics and
+    // the trace are not part of a snapshot; they pick up from the restore.
+    void save(SnapshotWriter& out) const {
+        out.writeInt(currentTime);
+        out.writeLong(totalCpuTime);
+        out.writeInt(sliceLeft);
+        out.writeInt(finished ? 1 : 0);
+        out.writeInt(pausedTime);
+        out.writeLong(overheadTime);
+        out.writeInt(overheadLeft);
+        out.writeInt(switchedIn ? 1 : 0);
+        out.writeInt(lastPid);
+        arrivals.saveState(out);
+
+        out.writeInt(running != nullptr ? 1 : 0);
+        if (running != nullptr) {
+            out.writeProcess(*running);
+        }
+        out.writeSize(ioQueue.size());
+        ioQueue.forEach([&out](Process* process) { out.writeProcess(*process); });
+
+        out.writeString(Policy::snapshotName());
+        SnapshotWriter state;
+        policy.saveState(state);
+        out.writeSection(state);
+        SnapshotWriter queued;
+        std::uint64_t queuedCount = 0;
+        policy.forEachQueued([&queued, &queuedCount](Process* process, int slot) {
+            queued.writeInt(slot);
+            queued.writeProcess(*process);
+            queuedCount++;
+        });
+        out.writeSize(queuedCount);
+        out.writeSection(queued);
+    }
+
+    // Resumes a run saved by save(). The engine must not have stepped yet and
+    // its arrival source must read the same workload. The snapshot may come
+    // from a different policy, which is how one warmed-up state forks into
+    // several what-ifs; the ready processes are then queued afresh.
+    void load(SnapshotReader& in) {
+        currentTime = in.readInt();
+        totalCpuTime = in.readLong();
+        sliceLeft = in.readInt();
+        finished = in.readInt() != 0;
+        pausedTime = in.readInt();
+        overheadTime = in.readLong();
+        overheadLeft = in.readInt();
+        switchedIn = in.readInt() != 0;
+        stopped = overheadLeft > 0 || switchedIn || pausedTime > 0;
+        lastPid = in.readInt();
+        arrivals.loadState(in);
+        nextArrivalTime = arrivals.nextArrivalTime();
+        policy.onClock(currentTime);
+
+        if (in.readInt() != 0) {
+            running = arrivals.restoreProcess(in.readProcess());
+            policy.restoreRunning(running);
+        }
+        for (std::uint64_t blocked = in.readSize(); blocked > 0; --blocked) {
+            ioQueue.push(arrivals.restoreProcess(in.readProcess()));
+        }
+
+        std::string name = in.readString();
+        bool samePolicy = !name.empty() && name == Policy::snapshotName();
+        SnapshotReader state = in.readSection();
+        if (samePolicy) {
+            policy.loadState(state);
+        }
+        std::uint64_t queuedCount = in.readSize();
+        SnapshotReader queued = in.readSection();
+        for (; queuedCount > 0; --queuedCount) {
+            int slot = queued.readInt();
+            policy.restoreQueued(arrivals.restoreProcess(queued.readProcess()), samePolicy ? slot : -1);
+            statistics.readied(currentTime);
+        }
+    }
+
+    void checkpoint(const std::string& path) const {
+        SnapshotWriter out;
+        save(out);
+        out.save(path);
+    }
+
+    void restore(const std::string& path) {
+        SnapshotFile file(path);
+        SnapshotReader in = file.reader();
+        load(in);
+    }
+
+private:
+    // Carries on with whatever the horizon stopped, as though it had never
+    // stopped: a dispatch still switching in, one whose switch ended at the
+    // horizon, or a run segment. True if that was the whole step; false if a
+    // preemptive policy must first react to an event at the paused segment.
+    bool resume() {
+        stopped = false;
+        if (overheadLeft > 0 || switchedIn || !policy.preemptive()
+            || std::min(ioQueue.nextCompletionTime(), nextArrivalTime) > currentTime) {
+            switchedIn = false;
+            runSegment();
+            return true;
+        }
+        policy.onRan(running, pausedTime);
+        pausedTime = 0;
+        return false;
+    }
+
+    void admitArrivals() {
+        while (nextArrivalTime <= currentTime) {
+            Process* process = arrivals.admit();
+            nextArrivalTime = arrivals.nextArrivalTime();
+            process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+            process->arrivalTime = process->initialArrivalTime;
+            process->queueLevel = 1;
+            policy.enqueue(process);
+            statistics.readied(process->arrivalTime);
+        }
+    }
+
+    void drainIo() {
+        if (ioQueue.nextCompletionTime() > currentTime) {
+            return;
+        }
+        ioQueue.drainUntil(currentTime, [this](Process* process, int ioCompletionTime) {
+            process->currentBurstIndex++;
+            if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                process->arrivalTime = ioCompletionTime;
+                process->timeSliceUsed = 0;
+                policy.enqueue(process);
+                statistics.readied(ioCompletionTime);
+            }
+            else {
+                // Process has completed all CPU bursts
+                complete(process, ioCompletionTime);
+            }
+        });
+    }
+
+    void dispatch(Process* process) {
+        running = process;
+        statistics.dispatched(currentTime);
+
+        // The process starts once the CPU has switched to it
+        int start = currentTime;
+        if (chargesOverhead) {
+            overheadLeft = costs.overhead(*process, lastPid, 0, currentTime);
+            start = simulatedTime(static_cast<long long>(currentTime) + overheadLeft);
+            if (overheadLeft > 0) {
+                trace.record({ currentTime, process->pid, TraceEventKind::SwitchIn, overheadLeft, 0 });
+            }
+        }
+        lastPid = process->pid;
+
+        // Record response time if not already set
+        if (process->responseTime == -1) {
+            process->responseTime = start - process->initialArrivalTime;
+        }
+
+        // Update waiting time
+        process->waitingTime += start - process->arrivalTime;
+        process->longestWait = std::max(process->longestWait, start - process->arrivalTime);
+        process->timeSliceUsed = 0;
+        sliceLeft = policy.timeSlice(*process);
+
+        if (policy.reportsSlices()) {
+            trace.record({ start, process->pid, TraceEventKind::RunSlice, sliceLeft, process->queueLevel });
+        }
+        else {
+            trace.record({ start, process->pid, TraceEventKind::RunBurst, process->remainingCpuTime, 0 });
+        }
+    }
+
+    // Spends the rest of the dispatch overhead. False if the horizon stopped it.
+    bool switchIn() {
+        int span = overheadLeft;
+        bool pause = horizon > currentTime && horizon - currentTime <= span;
+        if (pause) {
+            span = horizon - currentTime;
+        }
+        currentTime = simulatedTime(static_cast<long long>(currentTime) + span);
+        overheadTime += span;
+        overheadLeft -= span;
+        switchedIn = pause && overheadLeft == 0;
+        stopped = pause;
+        return !pause;
+    }
+
+    // Runs the current process to the end of its slice or, under a preemptive
+    // policy, to the next arrival or I/O completion if that comes first.
+    void runSegment() {
+        if (overheadLeft > 0 && !switchIn()) {
+            return;
+        }
+        int executionTime = sliceLeft;
+        if (policy.preemptive()) {
+            // An event during the switch leaves the preemption check to the next step
+            int nextEventTime = std::min(ioQueue.nextCompletionTime(), nextArrivalTime);
+            if (nextEventTime != INT_MAX) {
+                executionTime = std::max(0, std::min(executionTime, nextEventTime - currentTime));
+            }
+        }
+        bool pause = horizon > currentTime && horizon - currentTime <= executionTime;
+        if (pause) {
+            executionTime = horizon - currentTime;
+        }
+        currentTime = simulatedTime(static_cast<long long>(currentTime) + executionTime);
+        totalCpuTime += executionTime;
+        running->lastRanAt = currentTime;
+        running->remainingCpuTime -= executionTime;
+        running->timeSliceUsed += executionTime;
+        sliceLeft -= executionTime;
+        if (pause) {
+            // The policy hears about the whole stretch once it ends
+            pausedTime += executionTime;
+            stopped = true;
+            return;
+        }
+        policy.onRan(running, pausedTime + executionTime);
+        pausedTime = 0;
+        policy.onClock(currentTime);
+
+        if (running->remainingCpuTime == 0) {
+            finishBurst();
+        }
+        else if (sliceLeft == 0) {
+            // Requeue behind everything that became ready during the slice
+            admitArrivals();
+            drainIo();
+            Process* process = running;
+            int level = process->queueLevel;
+            process->timeSliceUsed = 0;
+            process->arrivalTime = currentTime;
+            running = nullptr;
+            policy.onQuantumExpired(process);
+            statistics.readied(currentTime);
+            if (process->queueLevel != level) {
+                trace.record({ currentTime, process->pid, TraceEventKind::Demoted, 0, process->queueLevel });
+            }
+        }
+        // Else the slice was cut short by an event; the next step decides whether to preempt
+    }
+
+    void finishBurst() {
+        Process* process = running;
+        running = nullptr;
+        if (policy.reportsSlices()) {
+            trace.record({ currentTime, process->pid, TraceEventKind::BurstComplete, 0, 0 });
+        }
+
+        // Check if there is a corresponding I/O burst
+        if (process->currentBurstIndex < static_cast<int>(process->ioTimes.size())) {
+            process->remainingIoTime = process->ioTimes[process->currentBurstIndex];
+            process->arrivalTime = currentTime;
+            ioQueue.push(process);
+            trace.record({ currentTime, process->pid, TraceEventKind::IoStart, process->remainingIoTime, 0 });
+        }
+        else {
+            trace.record({ currentTime, process->pid, TraceEventKind::Completed, 0, 0 });
+            complete(process, currentTime);
+        }
+    }
+
+    void complete(Process* process, int completionTime) {
+        process->isCompleted = true;
+        process->turnaroundTime = completionTime - process->initialArrivalTime;
+        statistics.completed(*process, completionTime);
+        arrivals.retire(process);
+    }
+
+    void finish() {
+        finished = true;
+        statistics.finished(currentTime);
+        trace.record({ currentTime, 0, TraceEventKind::RunFinished, static_cast<int>(totalCpuTime), currentTime });
+    }
+
+    ArrivalSource& arrivals;
+    Policy policy;
+    TraceSink& trace;
+    Statistics statistics;
+    CostModel costs;
+    bool chargesOverhead = false;
+    int nextArrivalTime;   // Cached from the source, which only changes it on admit()
+    IoEventQueue ioQueue;
+    Process* running = nullptr;
+    int sliceLeft = 0;
+    int horizon = INT_MAX;
+    int pausedTime = 0;    // Run so far in a segment stopped at the horizon
+    int overheadLeft = 0;  // Dispatch overhead still to spend before the running process runs
+    bool switchedIn = false;  // A dispatch's overhead ended at the horizon, before its segment
+    bool stopped = false;     // The horizon cut a dispatch or segment short; see resume()
+    int lastPid = -1;      // Process the CPU last switched to
+    int currentTime = 0;
+    long long totalCpuTime = 0;
+    long long overheadTime = 0;
+    bool finished = false;
+};
+
+template <typename Policy>
+SchedulerResult runEngine(ArrivalSource& arrivals, Policy policy, TraceSink& trace) {
+    return Engine<Policy>(arrivals, std::move(policy), trace).run();
+}
+
+template <typename Policy, typename Statistics>
+SchedulerResult runEngine(ArrivalSource& arrivals, Policy policy, TraceSink& trace, Statistics& statistics) {
+    return Engine<Policy, Statistics&>(arrivals, std::move(policy), trace, statistics).run();
+}
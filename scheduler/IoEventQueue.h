@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "Process.h"
+
+
+// Processes blocked on I/O, kept in a min-heap keyed on their completion time
+// (arrivalTime + remainingIoTime). Finding the next wake-up and draining the
+// completions due by a given time are O(log n) per process instead of a scan
+// over every blocked process.
+class IoEventQueue {
+public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void push(Process* process) {
+        heap.push_back({ simulatedTime(static_cast<long long>(process->arrivalTime) + process->remainingIoTime),
+                         nextSequence++, process });
+        std::push_heap(heap.begin(), heap.end(), Later());
+    }
+
+    int nextCompletionTime() const {
+        return heap.empty() ? INT_MAX : heap.front().completionTime;
+    }
+
+    // Calls onComplete(process, completionTime) for every process whose I/O
+    // finishes at or before `time`. Processes are handed back in the order they
+    // started I/O, so ready queues fill up in the same order as a linear scan.
+    template <typename Callback>
+    void drainUntil(int time, Callback&& onComplete) {
+        due.clear();
+        while (!heap.empty() && heap.front().completionTime <= time) {
+            std::pop_heap(heap.begin(), heap.end(), Later());
+            due.push_back(heap.back());
+            heap.pop_back();
+        }
+        if (due.size() > 1) {
+            std::sort(due.begin(), due.end(),
+                [](const Event& a, const Event& b) { return a.sequence < b.sequence; });
+        }
+        for (const Event& event : due) {
+            onComplete(event.process, event.completionTime);
+        }
+    }
+
+    // Calls visit(process) for every blocked process in the order it started I/O.
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        std::vector<Event> started(heap);
+        std::sort(started.begin(), started.end(),
+            [](const Event& a, const Event& b) { return a.sequence < b.sequence; });
+        for (const Event& event : started) {
+            visit(event.process);
+        }
+    }
+
+private:
+    struct Event {
+        int completionTime;
+        unsigned long long sequence;
+        Process* process;
+    };
+
+    struct Later {
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.completionTime != b.completionTime) {
+                return a.completionTime > b.completionTime;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    std::vector<Event> heap;
+    std::vector<Event> due;
+    unsigned long long nextSequence = 0;
+};
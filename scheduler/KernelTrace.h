@@ -0,0 +1,479 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Process.h"
+#include "ThreadPool.h"
+#include "TraceFile.h"
+
+
+// Imports Linux scheduler captures as workload traces. Reads the text dumps
+// of `perf script` over a `perf sched record`, of `trace-cmd report`, and of
+// the ftrace buffer (/sys/kernel/tracing/trace) with the sched_switch and
+// sched_wakeup events enabled. Events may be in the key=value format of
+// current kernels or the compact `comm:pid [prio] S ==> comm:pid [prio]` form
+// of older tools. Every other line is skipped.
+//
+// Each task becomes a process:
+//   - Time it spends switched in counts towards its current CPU burst.
+//   - Switched out runnable (prev_state R) is a preemption and does not end
+//     the burst.
+//   - Switched out blocked (S, D, ...) ends the burst and starts an I/O wait
+//     that lasts until the task is woken.
+//   - It arrives when first seen, relative to the first event of the
+//     capture. A task already running then is placed as described at
+//     KernelTraceImporter.
+//   - It ends when it exits (prev_state X or Z), so a reused pid starts a
+//     new process.
+// The idle task (pid 0) and tasks never seen running are left out.
+struct KernelTraceOptions {
+    double tickNanoseconds = 1000.0;   // Length of one simulated time unit
+    unsigned threads = std::thread::hardware_concurrency();
+    size_t chunkBytes = size_t(8) << 20;   // Capture each parsing task takes on
+};
+
+struct KernelTraceSummary {
+    long long lines = 0;
+    long long events = 0;
+    long long processes = 0;
+    long long droppedTasks = 0;   // Seen in the capture but never ran
+};
+
+enum class SchedEventKind : std::uint8_t { Switch, Wakeup };
+
+// One sched_switch or sched_wakeup, reduced to what the importer needs.
+struct SchedEvent {
+    std::int64_t time;    // Nanoseconds since boot
+    int pid;              // Task switched out, or the task woken
+    int nextPid;          // Task switched in
+    SchedEventKind kind;
+    char prevState;       // 'R' still runnable, 'X' exited, 'S' blocked any other way
+};
+
+// Zero-copy parsing of capture lines straight out of the mapped file.
+class SchedEventParser {
+public:
+    // Appends the events in [begin, end), which must start at a line start.
+    // Returns the number of lines read.
+    static long long parse(const char* begin, const char* end, std::vector<SchedEvent>& events) {
+        long long lines = 0;
+        while (begin < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            SchedEvent event;
+            if (parseLine(begin, lineEnd, event)) {
+                events.push_back(event);
+            }
+            lines++;
+            begin = lineEnd < end ? lineEnd + 1 : end;
+        }
+        return lines;
+    }
+
+    static bool parseLine(const char* begin, const char* end, SchedEvent& event) {
+        const char* name = find(begin, end, "sched_switch: ");
+        const char* fields;
+        if (name != end) {
+            event.kind = SchedEventKind::Switch;
+            fields = name + 14;
+        }
+        else {
+            name = find(begin, end, "sched_wakeup");
+            if (name == end) {
+                return false;
+            }
+            if (startsWith(name + 12, end, ": ")) {
+                fields = name + 14;
+            }
+            else if (startsWith(name + 12, end, "_new: ")) {
+                fields = name + 18;
+            }
+            else {
+                return false;
+            }
+            event.kind = SchedEventKind::Wakeup;
+        }
+        if (!parseTimestamp(begin, name, event.time)) {
+            return false;
+        }
+        if (event.kind == SchedEventKind::Wakeup) {
+            event.nextPid = 0;
+            event.prevState = 'R';
+            return parseWakeup(fields, end, event);
+        }
+        return parseSwitch(fields, end, event);
+    }
+
+private:
+    static const char* find(const char* begin, const char* end, const char* needle) {
+        return std::search(begin, end, needle, needle + std::strlen(needle));
+    }
+
+    static bool startsWith(const char* position, const char* end, const char* prefix) {
+        size_t length = std::strlen(prefix);
+        return static_cast<size_t>(end - position) >= length && std::memcmp(position, prefix, length) == 0;
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool parseNumber(const char* position, const char* end, int& value) {
+        if (position >= end || !isDigit(*position)) {
+            return false;
+        }
+        long long number = 0;
+        for (; position < end && isDigit(*position); ++position) {
+            number = number * 10 + (*position - '0');
+            if (number > INT_MAX) {
+                return false;
+            }
+        }
+        value = static_cast<int>(number);
+        return true;
+    }
+
+    // The `seconds.fraction:` before the event name, past perf's "sched:" prefix.
+    static bool parseTimestamp(const char* begin, const char* name, std::int64_t& time) {
+        const char* position = name;
+        if (position - begin >= 6 && std::memcmp(position - 6, "sched:", 6) == 0) {
+            position -= 6;
+        }
+        while (position > begin && position[-1] == ' ') {
+            --position;
+        }
+        if (position == begin || position[-1] != ':') {
+            return false;
+        }
+        const char* last = --position;
+        while (position > begin && (isDigit(position[-1]) || position[-1] == '.')) {
+            --position;
+        }
+        std::int64_t seconds = 0;
+        std::int64_t nanoseconds = 0;
+        int fractionDigits = -1;
+        for (const char* c = position; c < last; ++c) {
+            if (*c == '.') {
+                if (fractionDigits >= 0) {
+                    return false;
+                }
+                fractionDigits = 0;
+            }
+            else if (fractionDigits < 0) {
+                seconds = seconds * 10 + (*c - '0');
+            }
+            else if (fractionDigits < 9) {
+                nanoseconds = nanoseconds * 10 + (*c - '0');
+                fractionDigits++;
+            }
+        }
+        if (position == last || fractionDigits < 0) {
+            return false;
+        }
+        for (; fractionDigits < 9; ++fractionDigits) {
+            nanoseconds *= 10;
+        }
+        time = seconds * 1000000000 + nanoseconds;
+        return true;
+    }
+
+    static char classifyState(char state) {
+        if (state == 'R') {
+            return 'R';
+        }
+        return state == 'X' || state == 'Z' || state == 'x' ? 'X' : 'S';
+    }
+
+    // The pid of a compact `comm:pid [prio]` task, from the " [" after it.
+    static bool parseCompactPid(const char* begin, const char* bracket, int& pid) {
+        const char* digits = bracket;
+        while (digits > begin && isDigit(digits[-1])) {
+            --digits;
+        }
+        return digits != bracket && digits > begin && digits[-1] == ':' && parseNumber(digits, bracket, pid);
+    }
+
+    static bool parseSwitch(const char* fields, const char* end, SchedEvent& event) {
+        const char* arrow = find(fields, end, "==>");
+        if (arrow == end) {
+            return false;
+        }
+        const char* prevPid = find(fields, arrow, "prev_pid=");
+        if (prevPid != arrow) {
+            const char* state = find(fields, arrow, "prev_state=");
+            const char* nextPid = find(arrow, end, "next_pid=");
+            if (state == arrow || state + 11 >= arrow || nextPid == end) {
+                return false;
+            }
+            event.prevState = classifyState(state[11]);
+            return parseNumber(prevPid + 9, arrow, event.pid) && parseNumber(nextPid + 9, end, event.nextPid);
+        }
+
+        const char* bracket = find(fields, arrow, " [");
+        const char* close = std::find(bracket, arrow, ']');
+        if (close == arrow || !parseCompactPid(fields, bracket, event.pid)) {
+            return false;
+        }
+        const char* state = close + 1;
+        while (state < arrow && *state == ' ') {
+            ++state;
+        }
+        if (state == arrow) {
+            return false;
+        }
+        event.prevState = classifyState(*state);
+        const char* next = arrow + 3;
+        const char* nextBracket = find(next, end, " [");
+        return parseCompactPid(next, nextBracket, event.nextPid);
+    }
+
+    static bool parseWakeup(const char* fields, const char* end, SchedEvent& event) {
+        const char* pid = find(fields, end, " pid=");
+        if (pid != end) {
+            return parseNumber(pid + 5, end, event.pid);
+        }
+        if (startsWith(fields, end, "pid=")) {
+            return parseNumber(fields + 4, end, event.pid);
+        }
+        const char* bracket = find(fields, end, " [");
+        return bracket != end && parseCompactPid(fields, bracket, event.pid);
+    }
+};
+
+// Folds events, in capture order, into the bursts of each task, and hands
+// each finished task to `emit` in arrival order (first seen first among equal
+// times) as soon as every task that arrived before it has been handed over.
+// A task that lives on holds back only the tasks that arrived after it.
+//
+// A task already running when the capture began is only recognised when it
+// is first switched out. It arrives at 0, or with the last task handed over
+// if some already were, so the order never has to be revised.
+class KernelTraceImporter {
+public:
+    using Emit = std::function<void(const Process&)>;
+
+    explicit KernelTraceImporter(Emit emit, const KernelTraceOptions& options = KernelTraceOptions())
+        : emit(std::move(emit)), tick(options.tickNanoseconds > 0.0 ? options.tickNanoseconds : 1.0) {}
+
+    void apply(const SchedEvent& event) {
+        if (counts.events++ == 0) {
+            start = event.time;
+        }
+        std::int64_t time = std::max(event.time, latest);
+        latest = time;
+        if (event.kind == SchedEventKind::Wakeup) {
+            if (event.pid != 0) {
+                endIo(task(event.pid, time, false), time);
+            }
+            return;
+        }
+        if (event.pid != 0) {
+            switchOut(event.pid, time, event.prevState);
+        }
+        if (event.nextPid != 0) {
+            Task& next = task(event.nextPid, time, false);
+            endIo(next, time);
+            next.runningSince = time;
+        }
+    }
+
+    // Ends every task still alive at the last event and hands over the rest.
+    void finish() {
+        while (!live.empty()) {
+            Task& open = live.begin()->second;
+            if (open.runningSince >= 0) {
+                open.burst += latest - open.runningSince;
+                open.runningSince = -1;
+                endBurst(open);
+            }
+            else if (open.burst > 0) {
+                endBurst(open);
+            }
+            else if (!open.process.ioTimes.empty() && open.process.ioTimes.size() == open.process.cpuBursts.size()) {
+                // Woken but never ran again; the wait is not followed by a burst
+                open.process.ioTimes.pop_back();
+            }
+            retire(live.begin());
+        }
+    }
+
+    const KernelTraceSummary& summary() const { return counts; }
+    void addLines(long long lines) { counts.lines += lines; }
+
+private:
+    // Where a task goes in the output: its arrival, then when it was first seen
+    using Key = std::pair<int, long long>;
+
+    struct Task {
+        Task(int pid, long long order) : process(pid, {}, {}), order(order) {}
+
+        Key key() const { return { process.initialArrivalTime, order }; }
+
+        Process process;
+        long long order;
+        std::int64_t burst = 0;            // CPU time in the current burst so far
+        std::int64_t runningSince = -1;    // Switched in at, -1 when not running
+        std::int64_t blockedSince = -1;    // Blocked at, -1 when not blocked
+    };
+
+    // A task first seen being switched out has been running since the capture began.
+    Task& task(int pid, std::int64_t time, bool running) {
+        auto found = live.find(pid);
+        if (found != live.end()) {
+            return found->second;
+        }
+        Task& created = live.emplace(pid, Task(pid, nextOrder++)).first->second;
+        created.process.initialArrivalTime = running ? emittedArrival : ticks(time - start);
+        created.process.arrivalTime = created.process.initialArrivalTime;
+        created.runningSince = running ? start : -1;
+        liveKeys.insert(created.key());
+        return created;
+    }
+
+    void switchOut(int pid, std::int64_t time, char state) {
+        Task& previous = task(pid, time, true);
+        if (previous.runningSince >= 0) {
+            previous.burst += time - previous.runningSince;
+            previous.runningSince = -1;
+        }
+        if (state == 'R') {
+            return;
+        }
+        endBurst(previous);
+        if (state == 'X') {
+            retire(live.find(pid));
+            return;
+        }
+        previous.blockedSince = time;
+    }
+
+    void endBurst(Task& running) {
+        running.process.cpuBursts.push_back(std::max(1, ticks(running.burst)));
+        running.burst = 0;
+    }
+
+    void endIo(Task& blocked, std::int64_t time) {
+        if (blocked.blockedSince >= 0) {
+            blocked.process.ioTimes.push_back(ticks(time - blocked.blockedSince));
+            blocked.blockedSince = -1;
+        }
+    }
+
+    void retire(std::unordered_map<int, Task>::iterator position) {
+        Task& retired = position->second;
+        liveKeys.erase(retired.key());
+        if (retired.process.cpuBursts.empty()) {
+            counts.droppedTasks++;
+        }
+        else {
+            finished.emplace(retired.key(), std::move(retired.process));
+        }
+        live.erase(position);
+
+        // Hand over every finished task that no live task arrived before
+        while (!finished.empty() && (liveKeys.empty() || finished.begin()->first < *liveKeys.begin())) {
+            emittedArrival = finished.begin()->first.first;
+            emit(finished.begin()->second);
+            counts.processes++;
+            finished.erase(finished.begin());
+        }
+    }
+
+    int ticks(std::int64_t nanoseconds) const {
+        return static_cast<int>(std::min<double>(std::llround(nanoseconds / tick), INT_MAX));
+    }
+
+    Emit emit;
+    double tick;
+    std::int64_t start = 0;
+    std::int64_t latest = 0;
+    long long nextOrder = 0;
+    int emittedArrival = 0;              // Arrival of the last task handed over
+    std::unordered_map<int, Task> live;
+    std::set<Key> liveKeys;
+    std::map<Key, Process> finished;     // Waiting for an earlier live task to finish
+    KernelTraceSummary counts;
+};
+
+// Converts a capture into a trace file. The capture is mapped and cut at line
+// boundaries into chunks, which are consecutive time ranges. Each batch of
+// chunks is parsed in parallel while the previous batch is folded, and tasks
+// are written out as the importer hands them over. Memory holds two batches
+// of events, the live tasks, and the finished tasks waiting behind an earlier
+// live one. Short-lived tasks therefore cost nothing once written, but a
+// task that lives for the whole capture keeps every later arrival in memory
+// until the end.
+inline KernelTraceSummary importKernelTrace(const std::string& capturePath, const std::string& outputPath,
+                                            TraceFormat format, const KernelTraceOptions& options = KernelTraceOptions()) {
+    MappedFile capture(capturePath);
+    const char* data = capture.data();
+    const char* end = data + capture.size();
+    size_t chunkBytes = std::max<size_t>(options.chunkBytes, 1);
+    std::vector<std::pair<const char*, const char*>> chunks;
+    for (const char* position = data; position < end;) {
+        const char* limit = static_cast<size_t>(end - position) > chunkBytes ? position + chunkBytes : end;
+        const char* newline = limit < end ? static_cast<const char*>(std::memchr(limit, '\n', end - limit)) : nullptr;
+        const char* chunkEnd = newline != nullptr ? newline + 1 : end;
+        chunks.emplace_back(position, chunkEnd);
+        position = chunkEnd;
+    }
+
+    ThreadPool pool(options.threads);
+    size_t batch = pool.size();
+    std::vector<std::vector<SchedEvent>> parsed(2 * batch);
+    std::vector<long long> lines(2 * batch);
+    auto parseBatch = [&](size_t first, size_t slot) {
+        for (size_t i = 0; i < batch && first + i < chunks.size(); ++i) {
+            size_t buffer = slot * batch + i;
+            std::pair<const char*, const char*> chunk = chunks[first + i];
+            pool.submit([&parsed, &lines, buffer, chunk] {
+                parsed[buffer].clear();
+                lines[buffer] = SchedEventParser::parse(chunk.first, chunk.second, parsed[buffer]);
+            });
+        }
+    };
+
+    std::unique_ptr<TraceWriter> writer;
+    KernelTraceImporter importer([&writer, &outputPath, format](const Process& process) {
+        if (!writer) {
+            writer.reset(new TraceWriter(outputPath, format));
+        }
+        writer->write(process);
+    }, options);
+    parseBatch(0, 0);
+    for (size_t first = 0, slot = 0; first < chunks.size(); first += batch, slot ^= 1) {
+        pool.wait();
+        if (first + batch < chunks.size()) {
+            parseBatch(first + batch, slot ^ 1);
+        }
+        for (size_t i = 0; i < batch && first + i < chunks.size(); ++i) {
+            for (const SchedEvent& event : parsed[slot * batch + i]) {
+                importer.apply(event);
+            }
+            importer.addLines(lines[slot * batch + i]);
+        }
+    }
+    pool.wait();
+
+    importer.finish();
+    if (!writer) {
+        throw std::runtime_error(capturePath + ": no sched_switch events found");
+    }
+    writer->finish();
+    return importer.summary();
+}
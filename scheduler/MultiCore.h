@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "Comparison.h"
+#include "CostModel.h"
+#include "IoEventQueue.h"
+#include "Policies.h"
+#include "Process.h"
+#include "ThreadPool.h"
+
+
+// Shape of a multi-core run. Cores are grouped into balancing domains: an idle
+// core steals from the busiest core of its own domain as soon as it runs dry,
+// while work moves between domains only at the rebalance points every
+// rebalanceInterval time units. Between those points the domains do not
+// interact, which is what lets them be simulated on different host threads.
+struct MultiCoreConfig {
+    int cores = 4;
+    int coresPerDomain = 4;
+    int rebalanceInterval = 20;
+    CostModel costs;           // Dispatch overheads; a migrated process starts cold
+};
+
+struct CoreStats {
+    long long busyTime = 0;
+    long long dispatches = 0;
+    long long migrations = 0;  // Dispatches of a process that last ran on another core
+    long long steals = 0;      // Processes this core took from another core's queue
+    long long overheadTime = 0;  // Time spent switching processes in, not counted as busy
+};
+
+struct MultiCoreResult {
+    std::vector<CoreStats> cores;
+    int makespan = 0;          // Time at which the last process finished
+
+    double utilization(size_t core) const {
+        return makespan > 0 ? 100.0 * cores[core].busyTime / makespan : 0.0;
+    }
+
+    long long migrations() const {
+        long long total = 0;
+        for (const CoreStats& core : cores) {
+            total += core.migrations;
+        }
+        return total;
+    }
+
+    long long overheadTime() const {
+        long long total = 0;
+        for (const CoreStats& core : cores) {
+            total += core.overheadTime;
+        }
+        return total;
+    }
+
+    // Busiest core's busy time over the mean; 1.0 is a perfectly even spread.
+    double loadImbalance() const {
+        long long total = 0;
+        long long busiest = 0;
+        for (const CoreStats& core : cores) {
+            total += core.busyTime;
+            busiest = std::max(busiest, core.busyTime);
+        }
+        return total > 0 ? static_cast<double>(busiest) * cores.size() / total : 1.0;
+    }
+};
+
+// One core's ready queue: a core's own instance of a policy from Policies.h,
+// which orders the queue, sizes time slices and demotes or boosts processes
+// as it does in Engine. The count is kept here for the balancer, since
+// policies do not report their length.
+template <typename Policy>
+class CoreQueue {
+public:
+    explicit CoreQueue(const Policy& policy) : policy(policy) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push(Process* process) {
+        policy.enqueue(process);
+        count++;
+    }
+
+    Process* pop() {
+        count--;
+        return policy.pickNext();
+    }
+
+    // Puts back a process that used up its time slice
+    void expire(Process* process) {
+        policy.onQuantumExpired(process);
+        count++;
+    }
+
+    // Puts back a preempted process and returns the one to run instead
+    Process* swap(Process* preempted) { return policy.swapRunning(preempted); }
+
+    Policy& scheduling() { return policy; }
+    const Policy& scheduling() const { return policy; }
+
+private:
+    Policy policy;
+    size_t count = 0;
+};
+
+// Simulates N cores, each with its own ready queue. New processes are placed
+// round-robin across the cores and return to the core they last ran on after
+// I/O. Time advances in epochs of rebalanceInterval units: at the start of an
+// epoch the host thread admits that epoch's arrivals and moves queued work from
+// the most loaded domains to idle cores elsewhere, then every domain advances
+// to the end of the epoch as a separate pool task. Domains only interact at
+// those barriers (conservative synchronization with the rebalance interval as
+// lookahead), so results are identical whatever the number of host threads.
+//
+// Every core runs its own copy of the policy, so the policy decides there
+// what it decides in Engine: which process runs next, for how long, whether
+// an arrival preempts it (see SchedulingPolicy) and where a process goes
+// when its slice expires.
+template <typename Policy>
+class MultiCoreSimulator {
+public:
+    MultiCoreSimulator(const MultiCoreConfig& config, const Policy& policy, ThreadPool& pool)
+        : config(config), pool(pool) {
+        if (config.cores < 1 || config.coresPerDomain < 1 || config.rebalanceInterval < 1) {
+            throw std::invalid_argument("multi-core runs need at least one core, one core per domain and a positive rebalance interval");
+        }
+        if (!config.costs.valid()) {
+            throw std::invalid_argument("switch, cold-cache and dispatch costs must not be negative");
+        }
+        cores.reserve(config.cores);
+        for (int c = 0; c < config.cores; ++c) {
+            cores.emplace_back(policy);
+        }
+        for (int first = 0; first < config.cores; first += config.coresPerDomain) {
+            domains.emplace_back();
+            domains.back().firstCore = first;
+            domains.back().endCore = std::min(config.cores, first + config.coresPerDomain);
+        }
+    }
+
+    MultiCoreResult run(ArrivalSource& arrivals) {
+        int nextCore = 0;
+        int epochStart = 0;
+        for (;;) {
+            int epochEnd = epochStart > INT_MAX - config.rebalanceInterval
+                ? INT_MAX : epochStart + config.rebalanceInterval;
+
+            // Place this epoch's arrivals round-robin across the cores
+            while (arrivals.nextArrivalTime() < epochEnd) {
+                Process* process = arrivals.admit();
+                process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                process->arrivalTime = process->initialArrivalTime;
+                process->queueLevel = 1;
+                Domain& domain = domains[nextCore / config.coresPerDomain];
+                domain.pending.push_back({ process, nextCore });
+                domain.active = true;
+                nextCore = (nextCore + 1) % config.cores;
+            }
+            balanceDomains(epochStart);
+
+            for (Domain& domain : domains) {
+                if (!domain.active && domain.nextEvent >= epochEnd) {
+                    continue;
+                }
+                pool.submit([this, &domain, epochStart, epochEnd] {
+                    try {
+                        advance(domain, epochStart, epochEnd);
+                    }
+                    catch (const std::exception& error) {
+                        domain.error = error.what();
+                    }
+                });
+            }
+            pool.wait();
+
+            // Hand finished processes back in a fixed order: by domain, then by completion
+            int nextEvent = arrivals.nextArrivalTime();
+            for (Domain& domain : domains) {
+                if (!domain.error.empty()) {
+                    throw std::runtime_error(domain.error);
+                }
+                for (Process* process : domain.retired) {
+                    arrivals.retire(process);
+                }
+                domain.retired.clear();
+                domain.active = false;
+                nextEvent = std::min(nextEvent, domain.nextEvent);
+            }
+            if (nextEvent == INT_MAX) {
+                break;
+            }
+            // Skip empty epochs rather than stepping through idle stretches
+            epochStart = std::max(epochEnd, nextEvent);
+        }
+
+        MultiCoreResult result;
+        for (const Core& core : cores) {
+            result.cores.push_back(core.stats);
+        }
+        for (const Domain& domain : domains) {
+            result.makespan = std::max(result.makespan, domain.lastCompletion);
+        }
+        return result;
+    }
+
+private:
+    struct Core {
+        explicit Core(const Policy& policy) : queue(policy) {}
+
+        CoreQueue<Policy> queue;
+        Process* running = nullptr;
+        int lastPid = -1;          // Process the core last switched to
+        int sliceStart = 0;        // When the running process starts, after any dispatch overhead
+        int sliceEnd = 0;
+        CoreStats stats;
+
+        bool idle() const { return running == nullptr && queue.empty(); }
+    };
+
+    struct Placement {
+        Process* process;
+        int core;
+    };
+
+    struct Domain {
+        int firstCore = 0;
+        int endCore = 0;
+        IoEventQueue ioQueue;
+        std::vector<Placement> pending;       // Arrivals placed on this domain's cores, in arrival order
+        std::vector<Process*> retired;        // Completed this epoch, waiting to be handed back
+        int nextEvent = INT_MAX;              // Earliest event after the last epoch
+        int lastCompletion = 0;
+        bool active = false;                  // Has new work at the start of this epoch
+        std::string error;
+    };
+
+    // Lets each idle core take one queued process from the busiest core of the
+    // most loaded other domain. Every queue first catches up to the start of
+    // the epoch, so a moved process finds the policy's clock where its old
+    // core left it.
+    void balanceDomains(int epochStart) {
+        if (domains.size() < 2) {
+            return;
+        }
+        for (Core& core : cores) {
+            core.queue.scheduling().onClock(epochStart);
+        }
+        std::vector<size_t> queued(domains.size(), 0);
+        for (size_t d = 0; d < domains.size(); ++d) {
+            for (int c = domains[d].firstCore; c < domains[d].endCore; ++c) {
+                queued[d] += cores[c].queue.size();
+            }
+        }
+        for (size_t d = 0; d < domains.size(); ++d) {
+            for (int c = domains[d].firstCore; c < domains[d].endCore; ++c) {
+                if (!cores[c].idle() || !domains[d].pending.empty()) {
+                    continue;
+                }
+                size_t donor = d;
+                for (size_t k = 0; k < domains.size(); ++k) {
+                    if (k == d) {
+                        continue;
+                    }
+                    if (donor == d || queued[k] > queued[donor]) {
+                        donor = k;
+                    }
+                }
+                if (queued[donor] == 0) {
+                    continue;
+                }
+                int victim = busiestCore(domains[donor]);
+                cores[c].queue.push(cores[victim].queue.pop());
+                cores[c].stats.steals++;
+                queued[donor]--;
+                queued[d]++;
+                domains[d].active = true;
+            }
+        }
+    }
+
+    int busiestCore(const Domain& domain) const {
+        int busiest = domain.firstCore;
+        for (int c = domain.firstCore + 1; c < domain.endCore; ++c) {
+            if (cores[c].queue.size() > cores[busiest].queue.size()) {
+                busiest = c;
+            }
+        }
+        return busiest;
+    }
+
+    // Runs one domain's cores from epochStart up to, but not including, epochEnd.
+    void advance(Domain& domain, int epochStart, int epochEnd) {
+        size_t nextPending = 0;
+        int currentTime = epochStart;
+        for (;;) {
+            for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                cores[c].queue.scheduling().onClock(currentTime);
+            }
+
+            // Admit arrivals, then move processes that have completed I/O back to their core
+            while (nextPending < domain.pending.size()
+                   && domain.pending[nextPending].process->initialArrivalTime <= currentTime) {
+                const Placement& placement = domain.pending[nextPending++];
+                cores[placement.core].queue.push(placement.process);
+            }
+            domain.ioQueue.drainUntil(currentTime, [&](Process* process, int ioCompletionTime) {
+                process->currentBurstIndex++;
+                if (process->currentBurstIndex < static_cast<int>(process->cpuBursts.size())) {
+                    process->remainingCpuTime = process->cpuBursts[process->currentBurstIndex];
+                    process->arrivalTime = ioCompletionTime;
+                    cores[process->lastCore].queue.push(process);
+                }
+                else {
+                    complete(domain, process, ioCompletionTime);
+                }
+            });
+
+            for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                if (cores[c].running != nullptr && cores[c].sliceEnd <= currentTime) {
+                    finishSlice(domain, cores[c], currentTime);
+                }
+            }
+
+            // Idle cores take their own work first, and only then steal from a neighbour
+            for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                if (cores[c].running == nullptr && !cores[c].queue.empty()) {
+                    dispatch(c, cores[c].queue.pop(), currentTime);
+                }
+            }
+            for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                if (cores[c].running == nullptr) {
+                    int victim = busiestCore(domain);
+                    if (!cores[victim].queue.empty()) {
+                        cores[c].stats.steals++;
+                        dispatch(c, cores[victim].queue.pop(), currentTime);
+                    }
+                }
+            }
+
+            // A preemptive policy checks every running process that has been
+            // switched in against its core's queue at each event
+            if (cores[domain.firstCore].queue.scheduling().preemptive()) {
+                for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                    Core& core = cores[c];
+                    if (core.running == nullptr || core.sliceStart > currentTime) {
+                        continue;
+                    }
+                    charge(core, currentTime);
+                    if (core.queue.scheduling().preemptor(*core.running) != nullptr) {
+                        Process* process = core.running;
+                        process->arrivalTime = currentTime;
+                        process->lastRanAt = currentTime;
+                        core.running = nullptr;
+                        dispatch(c, core.queue.swap(process), currentTime);
+                    }
+                }
+            }
+
+            int nextEvent = domain.ioQueue.nextCompletionTime();
+            if (nextPending < domain.pending.size()) {
+                nextEvent = std::min(nextEvent, domain.pending[nextPending].process->initialArrivalTime);
+            }
+            for (int c = domain.firstCore; c < domain.endCore; ++c) {
+                if (cores[c].running != nullptr) {
+                    nextEvent = std::min(nextEvent, cores[c].sliceEnd);
+                }
+            }
+            if (nextEvent >= epochEnd) {
+                domain.nextEvent = nextEvent;
+                domain.pending.erase(domain.pending.begin(), domain.pending.begin() + nextPending);
+                return;
+            }
+            currentTime = nextEvent;
+        }
+    }
+
+    void dispatch(int c, Process* process, int currentTime) {
+        Core& core = cores[c];
+
+        // The process starts once the core has switched to it
+        int overhead = config.costs.overhead(*process, core.lastPid, c, currentTime);
+        int start = simulatedTime(static_cast<long long>(currentTime) + overhead);
+        core.stats.overheadTime += overhead;
+        core.lastPid = process->pid;
+
+        // Record response time if not already set
+        if (process->responseTime == -1) {
+            process->responseTime = start - process->initialArrivalTime;
+        }
+        process->waitingTime += start - process->arrivalTime;
+        process->longestWait = std::max(process->longestWait, start - process->arrivalTime);
+
+        if (process->lastCore != -1 && process->lastCore != c) {
+            core.stats.migrations++;
+        }
+        process->lastCore = c;
+        core.stats.dispatches++;
+
+        core.running = process;
+        core.sliceStart = start;
+        core.sliceEnd = simulatedTime(static_cast<long long>(start) + core.queue.scheduling().timeSlice(*process));
+    }
+
+    // Accounts for the time the running process has run up to currentTime.
+    void charge(Core& core, int currentTime) {
+        int ran = currentTime - core.sliceStart;
+        core.stats.busyTime += ran;
+        core.running->remainingCpuTime -= ran;
+        core.queue.scheduling().onRan(core.running, ran);
+        core.sliceStart = currentTime;
+    }
+
+    void finishSlice(Domain& domain, Core& core, int currentTime) {
+        Process* process = core.running;
+        charge(core, currentTime);
+        process->lastRanAt = currentTime;
+        core.running = nullptr;
+
+        if (process->remainingCpuTime > 0) {
+            // Time slice used up: the policy requeues it on the same core
+            process->arrivalTime = currentTime;
+            core.queue.expire(process);
+        }
+        else if (process->currentBurstIndex < static_cast<int>(process->ioTimes.size())) {
+            process->remainingIoTime = process->ioTimes[process->currentBurstIndex];
+            process->arrivalTime = currentTime;
+            domain.ioQueue.push(process);
+        }
+        else {
+            complete(domain, process, currentTime);
+        }
+    }
+
+    void complete(Domain& domain, Process* process, int completionTime) {
+        process->isCompleted = true;
+        process->turnaroundTime = completionTime - process->initialArrivalTime;
+        domain.lastCompletion = std::max(domain.lastCompletion, completionTime);
+        domain.retired.push_back(process);
+    }
+
+    MultiCoreConfig config;
+    ThreadPool& pool;
+    std::vector<Core> cores;
+    std::vector<Domain> domains;
+};
+
+template <typename Policy>
+MultiCoreResult multiCoreScheduler(ArrivalSource& arrivals, const MultiCoreConfig& config, const Policy& policy, ThreadPool& pool) {
+    MultiCoreSimulator<Policy> simulator(config, policy, pool);
+    return simulator.run(arrivals);
+}
+
+inline void printMultiCore(const MultiCoreResult& result, const ComparisonRow& totals, std::ostream& out) {
+    // Dispatch overhead gets a column once a cost model charges any
+    bool overhead = result.overheadTime() > 0;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-6s %12s %9s %12s %12s %10s",
+        "Core", "Busy", "Util", "Dispatches", "Migrations", "Steals");
+    out << line << (overhead ? "     Overhead\n" : "\n");
+    for (size_t c = 0; c < result.cores.size(); ++c) {
+        const CoreStats& core = result.cores[c];
+        std::snprintf(line, sizeof(line), "%-6zu %12lld %8.2f%% %12lld %12lld %10lld",
+            c, core.busyTime, result.utilization(c), core.dispatches, core.migrations, core.steals);
+        out << line;
+        if (overhead) {
+            std::snprintf(line, sizeof(line), " %12lld", core.overheadTime);
+            out << line;
+        }
+        out << "\n";
+    }
+    std::snprintf(line, sizeof(line),
+        "\nProcesses %lld, makespan %d, migrations %lld, load imbalance %.3f\n"
+        "Avg wait %.2f, avg turnaround %.2f, avg response %.2f\n",
+        totals.completed, result.makespan, result.migrations(), result.loadImbalance(),
+        totals.average(totals.totalWaiting), totals.average(totals.totalTurnaround),
+        totals.average(totals.totalResponse));
+    out << line;
+    if (overhead) {
+        long long capacity = static_cast<long long>(result.makespan) * result.cores.size();
+        long long busy = 0;
+        for (const CoreStats& core : result.cores) {
+            busy += core.busyTime;
+        }
+        printTimeBreakdown(busy, result.overheadTime(), capacity, out);
+    }
+}
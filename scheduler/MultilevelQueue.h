@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Process.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// Run queue with one FIFO per priority level, in the style of the Linux O(1)
+// scheduler. Level 0 is the highest priority. Each level is a circular list
+// threaded through Process::nextInQueue, so queueing never allocates, and a
+// bitmap of non-empty levels finds the highest one with a count-trailing-zeros
+// per 64 levels. A process can be in at most one queue at a time.
+class MultilevelQueue {
+public:
+    static const int MaxLevels = 140;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    bool levelEmpty(int level) const { return tails[level] == nullptr; }
+
+    // Highest priority non-empty level, or -1 when the queue is empty.
+    int highestLevel() const { return nextLevel(0); }
+
+    // First non-empty level at or below `level` in priority, or -1.
+    int nextLevel(int level) const {
+        for (int word = level / 64; word < Words; ++word) {
+            std::uint64_t bits = bitmap[word];
+            if (word == level / 64) {
+                bits &= ~std::uint64_t(0) << (level % 64);
+            }
+            if (bits != 0) {
+                return word * 64 + countTrailingZeros(bits);
+            }
+        }
+        return -1;
+    }
+
+    // True when some level above (numerically below) `level` has work.
+    bool hasWorkAbove(int level) const {
+        int highest = highestLevel();
+        return highest != -1 && highest < level;
+    }
+
+    Process* front(int level) const { return tails[level]->nextInQueue; }
+
+    void push(Process* process, int level) {
+        Process*& tail = tails[level];
+        if (tail == nullptr) {
+            process->nextInQueue = process;
+            bitmap[level / 64] |= std::uint64_t(1) << (level % 64);
+        }
+        else {
+            process->nextInQueue = tail->nextInQueue;
+            tail->nextInQueue = process;
+        }
+        tail = process;
+        count++;
+    }
+
+    Process* pop(int level) {
+        Process*& tail = tails[level];
+        Process* head = tail->nextInQueue;
+        if (head == tail) {
+            tail = nullptr;
+            bitmap[level / 64] &= ~(std::uint64_t(1) << (level % 64));
+        }
+        else {
+            tail->nextInQueue = head->nextInQueue;
+        }
+        head->nextInQueue = nullptr;
+        count--;
+        return head;
+    }
+
+    // Appends every process of level `from` to level `to` in O(1).
+    void splice(int from, int to) {
+        Process* fromTail = tails[from];
+        if (fromTail == nullptr || from == to) {
+            return;
+        }
+        Process*& toTail = tails[to];
+        if (toTail == nullptr) {
+            bitmap[to / 64] |= std::uint64_t(1) << (to % 64);
+        }
+        else {
+            Process* toHead = toTail->nextInQueue;
+            toTail->nextInQueue = fromTail->nextInQueue;
+            fromTail->nextInQueue = toHead;
+        }
+        toTail = fromTail;
+        tails[from] = nullptr;
+        bitmap[from / 64] &= ~(std::uint64_t(1) << (from % 64));
+    }
+
+    // Front of the highest priority non-empty level. Only valid when not empty.
+    Process* pop() { return pop(highestLevel()); }
+
+    // Calls visit(process, level) for every queued process, highest level
+    // first and in FIFO order within a level.
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        for (int level = highestLevel(); level != -1; level = nextLevel(level + 1)) {
+            Process* process = tails[level];
+            do {
+                process = process->nextInQueue;
+                visit(process, level);
+            } while (process != tails[level]);
+        }
+    }
+
+private:
+    static const int Words = (MaxLevels + 63) / 64;
+
+    static int countTrailingZeros(std::uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    Process* tails[MaxLevels] = {};
+    std::uint64_t bitmap[Words] = {};
+    size_t count = 0;
+};
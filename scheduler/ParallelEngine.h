@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "CostModel.h"
+#include "Engine.h"
+#include "Process.h"
+#include "ThreadPool.h"
+#include "TraceSink.h"
+
+
+// Optimistic parallel execution of one large single-CPU simulation, with the
+// same results as running the engine once over the whole workload.
+//
+// The arrivals are cut into segments, and every segment is simulated on a
+// worker thread from a guess: that the system is empty when its first
+// process arrives. A run records its idle points, the moments when every
+// process it admitted has completed and the clock has reached the next
+// arrival. From an idle point on, a run depends only on the arrivals still to
+// come, so once the true run (the first segment's, which guessed nothing)
+// reaches an idle point that a later run also went through, the later run has
+// already simulated the true future and takes over there. Everything the
+// later run did before that point is thrown away. When no later run shares
+// the idle point, the guess failed and the true run carries on by itself on
+// the calling thread until it reaches one that does. A run that stopped
+// partway through a busy stretch can only be handed over to at an idle point
+// it recorded, but carries on from where it stopped.
+//
+// A run simulates the processes of its own segment in place. Any it runs on
+// into belong to the next segment's run, so it works on copies of those,
+// taken from their starting state, which is saved up front without the
+// bursts. At the end, the copies from the stretches that were kept are moved
+// onto the caller's processes.
+//
+// Handing over needs a policy that forgets everything when the system
+// empties (see SchedulingPolicy::forgetsWhenIdle); others, such as CFS and
+// lottery, run sequentially. With a switch cost, the runs must also agree on
+// the process the CPU last switched to. No trace is recorded.
+
+// Where a segment run found the system empty just before admitting the
+// process at `index` in arrival order. The point a run finished at has the
+// process count as its index.
+struct IdlePoint {
+    size_t index;
+    int lastPid;        // Process the CPU last switched to
+    long long cpuTime;        // Run totals so far
+    long long overheadTime;
+};
+
+// Starting states of the processes from `first` onwards in arrival order,
+// without their bursts.
+struct PristineProcesses {
+    size_t first = 0;
+    std::vector<Process> states;
+
+    // Saves processes [begin, end), as a slice of the states sized beforehand.
+    void save(const std::vector<Process*>& order, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Process& process = *order[i];
+            std::vector<int> cpu = std::move(process.cpuBursts);
+            std::vector<int> io = std::move(process.ioTimes);
+            states[i - first] = process;
+            process.cpuBursts = std::move(cpu);
+            process.ioTimes = std::move(io);
+        }
+    }
+};
+
+// Processes from one segment start onwards: those of the segment itself, up
+// to `end`, and copies of the rest.
+class SegmentArrivalSource : public ArrivalSource {
+public:
+    SegmentArrivalSource(const std::vector<Process*>& order, const PristineProcesses& pristine, size_t start, size_t end)
+        : order(order), pristine(pristine), end(end), next(start) {}
+
+    int nextArrivalTime() override {
+        return next < order.size() ? order[next]->initialArrivalTime : INT_MAX;
+    }
+
+    Process* admit() override {
+        Process* process = order[next];
+        if (next >= end) {
+            copies.push_back(pristine.states[next - pristine.first]);
+            copies.back().cpuBursts = process->cpuBursts;
+            copies.back().ioTimes = process->ioTimes;
+            process = &copies.back();
+        }
+        next++;
+        return process;
+    }
+
+    void retire(Process*) override {}
+
+    size_t position() const { return next; }
+
+    // Null if the process at `index` in arrival order is in the segment itself.
+    Process* copy(size_t index) { return index < end ? nullptr : &copies[index - end]; }
+
+private:
+    const std::vector<Process*>& order;
+    const PristineProcesses& pristine;
+    size_t end;
+    size_t next;
+    std::deque<Process> copies;   // Never moved, so the engine's pointers stay valid
+};
+
+// One engine simulating the workload from a segment start, as if the system
+// were empty there.
+template <typename Policy>
+class SegmentRun {
+public:
+    SegmentRun(const std::vector<Process*>& order, const PristineProcesses& pristine, size_t start, size_t end,
+               const Policy& policy, const CostModel& costs)
+        : arrivals(order, pristine, start, end), engine(arrivals, policy, discard), processCount(order.size()) {
+        engine.setCostModel(costs);
+    }
+
+    // Simulates up to the first idle point at or after `stopIndex`, or to the
+    // end of the workload, but gives up once it has admitted the process at
+    // `giveUpIndex`. False once the run has finished.
+    bool advance(size_t stopIndex, size_t giveUpIndex = SIZE_MAX) {
+        while (!finished) {
+            size_t index = arrivals.position();
+            if (index > giveUpIndex) {
+                return true;
+            }
+            if (engine.idle() && engine.now() == arrivals.nextArrivalTime()
+                && (idlePoints.empty() || idlePoints.back().index != index)) {
+                record(index);
+                if (index >= stopIndex) {
+                    return true;
+                }
+            }
+            if (!engine.step()) {
+                record(processCount);
+                finished = true;
+            }
+        }
+        return false;
+    }
+
+    bool done() const { return finished; }
+    int now() const { return engine.now(); }
+    const IdlePoint& lastIdlePoint() const { return idlePoints.back(); }
+    Process* copy(size_t index) { return arrivals.copy(index); }
+
+    // The idle point before the process at `index`, or null if the run did
+    // not go idle there.
+    const IdlePoint* idleAt(size_t index) const {
+        auto found = std::lower_bound(idlePoints.begin(), idlePoints.end(), index,
+            [](const IdlePoint& point, size_t value) { return point.index < value; });
+        return found != idlePoints.end() && found->index == index ? &*found : nullptr;
+    }
+
+private:
+    void record(size_t index) {
+        SchedulerResult totals = engine.result();
+        idlePoints.push_back({ index, engine.lastDispatched(), totals.totalCpuTime, totals.overheadTime });
+    }
+
+    SegmentArrivalSource arrivals;
+    NullTraceSink discard;
+    Engine<Policy> engine;
+    size_t processCount;
+    std::vector<IdlePoint> idlePoints;
+    bool finished = false;
+};
+
+// Runs `policy` over the processes as runEngine() would, on up to
+// pool.size() threads at once. The arrivals are cut into `segments` pieces,
+// by default eight per thread but none under 1024 processes, and just one on
+// a single thread. Results are written back to the processes, which must not
+// have been simulated yet.
+template <typename Policy>
+SchedulerResult runParallel(const std::vector<Process*>& processes, Policy policy, ThreadPool& pool,
+                            const CostModel& costs = CostModel(), size_t segments = 0) {
+    if (!policy.forgetsWhenIdle()) {
+        VectorArrivalSource arrivals(processes);
+        NullTraceSink discard;
+        Engine<Policy> engine(arrivals, std::move(policy), discard);
+        engine.setCostModel(costs);
+        return engine.run();
+    }
+
+    // Arrival order as VectorArrivalSource admits it
+    std::vector<Process*> order(processes);
+    std::stable_sort(order.begin(), order.end(), [](const Process* a, const Process* b) {
+        return a->initialArrivalTime < b->initialArrivalTime;
+    });
+
+    // Every segment starts with the first of the processes arriving at one time
+    if (segments == 0) {
+        segments = pool.size() > 1 ? std::max<size_t>(1, std::min(pool.size() * 8, order.size() / 1024)) : 1;
+    }
+    std::vector<size_t> starts = { 0 };
+    for (size_t k = 1; k < segments; ++k) {
+        size_t start = std::max(starts.back() + 1, order.size() * k / segments);
+        while (start < order.size() && order[start]->initialArrivalTime == order[start - 1]->initialArrivalTime) {
+            start++;
+        }
+        if (start >= order.size()) {
+            break;
+        }
+        starts.push_back(start);
+    }
+    starts.push_back(order.size());
+
+    // Only the first run starts before the second segment
+    PristineProcesses pristine;
+    pristine.first = starts[1];
+    pristine.states.resize(order.size() - pristine.first, Process(0, {}, {}));
+    for (size_t k = 1; k + 1 < starts.size(); ++k) {
+        pool.submit([&order, &pristine, &starts, k] { pristine.save(order, starts[k], starts[k + 1]); });
+    }
+    pool.wait();
+
+    std::vector<std::unique_ptr<SegmentRun<Policy>>> runs;
+    for (size_t k = 0; k + 1 < starts.size(); ++k) {
+        runs.emplace_back(new SegmentRun<Policy>(order, pristine, starts[k], starts[k + 1], policy, costs));
+    }
+    // A run that is still busy a whole segment past its own, as under
+    // overload, stops there rather than copy ever more processes
+    std::vector<std::string> errors(runs.size());
+    for (size_t k = 0; k < runs.size(); ++k) {
+        size_t stop = starts[k + 1];
+        size_t giveUp = k + 2 < starts.size() ? starts[k + 2] : SIZE_MAX;
+        pool.submit([&runs, &errors, k, stop, giveUp] {
+            try {
+                runs[k]->advance(stop, giveUp);
+            }
+            catch (const std::exception& error) {
+                errors[k] = error.what();
+            }
+        });
+    }
+    pool.wait();
+    for (const std::string& error : errors) {
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+    }
+
+    // Follow the true run from the start, handing over at every idle point a
+    // later run shares. Runs before `candidate` stopped too early to share one.
+    struct Stretch {
+        size_t run;
+        IdlePoint from;
+        IdlePoint to;
+    };
+    std::vector<Stretch> kept;
+    size_t current = 0;
+    IdlePoint from = { 0, -1, 0, 0 };
+    size_t candidate = 1;
+    for (;;) {
+        const IdlePoint at = runs[current]->lastIdlePoint();
+        if (runs[current]->done()) {
+            kept.push_back({ current, from, at });
+            break;
+        }
+        candidate = std::max(candidate, current + 1);
+        while (candidate < runs.size() && runs[candidate]->lastIdlePoint().index < at.index) {
+            candidate++;
+        }
+        size_t next = current;
+        const IdlePoint* shared = nullptr;
+        for (size_t k = candidate; k < runs.size() && starts[k] <= at.index; ++k) {
+            const IdlePoint* point = runs[k]->idleAt(at.index);
+            if (point != nullptr && (costs.switchCost == 0 || point->lastPid == at.lastPid)) {
+                next = k;
+                shared = point;
+            }
+        }
+        if (shared != nullptr) {
+            kept.push_back({ current, from, at });
+            current = next;
+            from = *shared;
+        }
+        else {
+            runs[current]->advance(at.index + 1);
+        }
+    }
+
+    SchedulerResult result;
+    for (const Stretch& stretch : kept) {
+        for (size_t i = stretch.from.index; i < stretch.to.index; ++i) {
+            if (Process* copy = runs[stretch.run]->copy(i)) {
+                copy->nextInQueue = nullptr;
+                *order[i] = std::move(*copy);
+            }
+        }
+        result.totalCpuTime += stretch.to.cpuTime - stretch.from.cpuTime;
+        result.overheadTime += stretch.to.overheadTime - stretch.from.overheadTime;
+    }
+    result.totalSimulationTime = runs[current]->now();
+    result.cpuUtilization = (static_cast<double>(result.totalCpuTime) / result.totalSimulationTime) * 100.0;
+    return result;
+}
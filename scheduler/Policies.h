@@ -0,0 +1,529 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MultilevelQueue.h"
+#include "Process.h"
+#include "ProcessRing.h"
+#include "ReadyHeap.h"
+#include "Snapshot.h"
+
+
+// Scheduling policies for Engine. A policy owns the ready queue and must
+// provide:
+//
+//   bool empty() const               no process is ready
+//   void enqueue(Process*)           a process arrived or finished its I/O
+//   Process* pickNext()              remove and return the process to run next
+//   void onQuantumExpired(Process*)  the running process used up its time slice
+//
+// and, to be checkpointed (see Engine::save),
+//
+//   void forEachQueued(visit) const  call visit(process, slot) for every ready process
+//
+// in an order restoreQueued() rebuilds the same queue from. SchedulingPolicy
+// supplies defaults for the optional hooks. The engine is instantiated per
+// policy type, so every call is resolved at compile time.
+template <typename Derived>
+struct SchedulingPolicy {
+    // Preemptive policies have their runs cut short at every arrival and I/O
+    // completion so preemptor() can be consulted.
+    bool preemptive() const { return false; }
+
+    // Trace each time slice with its queue level rather than each burst.
+    bool reportsSlices() const { return false; }
+
+    // Longest the process may run before onQuantumExpired().
+    int timeSlice(const Process& process) const { return process.remainingCpuTime; }
+
+    // A ready process that should take the CPU from `running`, if any.
+    Process* preemptor(const Process&) const { return nullptr; }
+
+    // Puts a preempted process back and returns the one to run instead.
+    Process* swapRunning(Process* preempted) {
+        Derived& self = *static_cast<Derived*>(this);
+        self.enqueue(preempted);
+        return self.pickNext();
+    }
+
+    // Called after the running process has run for `time` units.
+    void onRan(Process*, int) {}
+
+    // Called whenever simulated time moves, before any other hook at that time.
+    void onClock(int) {}
+
+    void onQuantumExpired(Process* process) { static_cast<Derived*>(this)->enqueue(process); }
+
+    // False if the policy remembers anything past a moment when no process
+    // is in the system, other than what onClock() derives from the time, so a
+    // run started afresh there would not go on the same way (see ParallelEngine.h).
+    bool forgetsWhenIdle() const { return true; }
+
+    // Names the policy in snapshots. Queue slots and saved state are only
+    // handed back to a policy of the same name.
+    static const char* snapshotName() { return ""; }
+
+    // State other than the ready queue, such as a random number generator.
+    void saveState(SnapshotWriter&) const {}
+    void loadState(SnapshotReader&) {}
+
+    // Puts back a process forEachQueued() visited. The slot is -1 when the
+    // snapshot came from a different policy.
+    void restoreQueued(Process* process, int) { static_cast<Derived*>(this)->enqueue(process); }
+
+    // Called for the process that was running when the snapshot was taken.
+    void restoreRunning(Process*) {}
+};
+
+// Load weight of a nice value, as in the Linux CFS weight table: each step
+// is worth about 10% of CPU share and nice 0 weighs 1024.
+inline int niceWeight(int nice) {
+    static const int weights[40] = {
+        88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+        9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+        1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+        110, 87, 70, 56, 45, 36, 29, 23, 18, 15,
+    };
+    return weights[std::min(19, std::max(-20, nice)) + 20];
+}
+
+// First come, first served: each burst runs to completion in arrival order.
+class FcfsPolicy : public SchedulingPolicy<FcfsPolicy> {
+public:
+    static const char* snapshotName() { return "FCFS"; }
+
+    bool empty() const { return readyQueue.empty(); }
+    void enqueue(Process* process) { readyQueue.push(process); }
+
+    Process* pickNext() {
+        Process* process = readyQueue.front();
+        readyQueue.pop();
+        return process;
+    }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (size_t i = 0; i < readyQueue.size(); ++i) {
+            visit(readyQueue.at(i), 0);
+        }
+    }
+
+private:
+    ProcessRing readyQueue;
+};
+
+// Shortest job first: the shortest next burst runs to completion.
+class SjfPolicy : public SchedulingPolicy<SjfPolicy> {
+public:
+    static const char* snapshotName() { return "SJF"; }
+
+    bool empty() const { return readyQueue.empty(); }
+    void enqueue(Process* process) { readyQueue.push(process); }
+    Process* pickNext() { return readyQueue.pop(); }
+
+    // The heap order is total, so any insertion order rebuilds the same picks
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (size_t i = 0; i < readyQueue.size(); ++i) {
+            visit(readyQueue.at(i), 0);
+        }
+    }
+
+private:
+    ReadyHeap readyQueue;
+};
+
+// Shortest remaining time first: SJF that preempts the running process as soon
+// as a ready process needs strictly less time than it has left.
+class SrtfPolicy : public SchedulingPolicy<SrtfPolicy> {
+public:
+    static const char* snapshotName() { return "SRTF"; }
+
+    bool preemptive() const { return true; }
+
+    bool empty() const { return readyQueue.empty(); }
+    void enqueue(Process* process) { readyQueue.push(process); }
+    Process* pickNext() { return readyQueue.pop(); }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (size_t i = 0; i < readyQueue.size(); ++i) {
+            visit(readyQueue.at(i), 0);
+        }
+    }
+
+    // The preemptor is always the top of the heap
+    Process* swapRunning(Process* preempted) { return readyQueue.replaceTop(preempted); }
+
+    // Preempt only for a strictly shorter remaining time, not on a PID tie
+    Process* preemptor(const Process& running) const {
+        if (!readyQueue.empty() && readyQueue.top()->remainingCpuTime < running.remainingCpuTime) {
+            return readyQueue.top();
+        }
+        return nullptr;
+    }
+
+private:
+    ReadyHeap readyQueue;
+};
+
+// Round robin with a fixed quantum.
+class RoundRobinPolicy : public SchedulingPolicy<RoundRobinPolicy> {
+public:
+    explicit RoundRobinPolicy(int quantum = 5) : quantum(quantum) {}
+
+    static const char* snapshotName() { return "RR"; }
+
+    int quantumLength() const { return quantum; }
+    int timeSlice(const Process& process) const { return std::min(process.remainingCpuTime, quantum); }
+
+    bool empty() const { return readyQueue.empty(); }
+    void enqueue(Process* process) { readyQueue.push(process); }
+
+    Process* pickNext() {
+        Process* process = readyQueue.front();
+        readyQueue.pop();
+        return process;
+    }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (size_t i = 0; i < readyQueue.size(); ++i) {
+            visit(readyQueue.at(i), 0);
+        }
+    }
+
+private:
+    int quantum;
+    ProcessRing readyQueue;
+};
+
+// Shape of the multilevel feedback queue. Level i (1-based) runs each process
+// for quanta[i - 1] units before demoting it to level i + 1. A quantum of 0 on
+// the last level makes it FCFS: a process there runs until its burst ends.
+// Up to MultilevelQueue::MaxLevels levels.
+//
+// Two optional guards against starvation of demoted processes:
+//   boostPeriod      every boostPeriod time units, every process returns to level 1
+//   agingThreshold   a process left waiting that long in one level moves up a level
+// Zero disables either.
+struct MlfqConfig {
+    std::vector<int> quanta = { 5, 10, 0 };
+    int boostPeriod = 0;
+    int agingThreshold = 0;
+
+    int levels() const { return static_cast<int>(quanta.size()); }
+
+    bool valid() const {
+        if (quanta.empty() || levels() > MultilevelQueue::MaxLevels || boostPeriod < 0 || agingThreshold < 0) {
+            return false;
+        }
+        for (size_t i = 0; i < quanta.size(); ++i) {
+            if (quanta[i] < 0 || (quanta[i] == 0 && i + 1 != quanta.size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Multilevel feedback queue. Every arrival starts at level 1; a process that
+// uses up its quantum moves down a level, and one that blocks for I/O keeps
+// its level.
+//
+// Neither guard scans the waiting processes. A boost splices every lower
+// level onto the end of level 1, which costs one step per level, and bumps an
+// epoch counter; each process's queueLevel is corrected lazily the next time
+// it is queued or picked. Aging only looks at the head of each lower level,
+// since a level is FIFO and its head has waited there longest.
+class MlfqPolicy : public SchedulingPolicy<MlfqPolicy> {
+public:
+    explicit MlfqPolicy(const MlfqConfig& config)
+        : quanta(config.quanta), boostPeriod(config.boostPeriod), agingThreshold(config.agingThreshold) {}
+
+    static const char* snapshotName() { return "MLFQ"; }
+
+    bool reportsSlices() const { return true; }
+
+    int timeSlice(const Process& process) const {
+        int quantum = quanta[process.queueLevel - 1];
+        return quantum == 0 ? process.remainingCpuTime : std::min(process.remainingCpuTime, quantum);
+    }
+
+    void onClock(int now) {
+        currentTime = now;
+        if (boostPeriod > 0 && now / boostPeriod != boostEpoch) {
+            boostEpoch = now / boostPeriod;
+            boosts++;
+            for (int level = queues.nextLevel(1); level != -1; level = queues.nextLevel(level + 1)) {
+                queues.splice(level, 0);
+            }
+        }
+        if (agingThreshold > 0) {
+            promoteAged();
+        }
+    }
+
+    bool empty() const { return queues.empty(); }
+
+    void enqueue(Process* process) {
+        refreshLevel(process);
+        process->queuedSince = currentTime;
+        queues.push(process, process->queueLevel - 1);
+    }
+
+    // Front of the highest priority non-empty queue
+    Process* pickNext() {
+        Process* process = queues.pop();
+        refreshLevel(process);
+        return process;
+    }
+
+    void onQuantumExpired(Process* process) {
+        refreshLevel(process);
+        if (process->queueLevel < static_cast<int>(quanta.size())) {
+            process->queueLevel++;
+        }
+        enqueue(process);
+    }
+
+    long long boostCount() const { return boosts; }
+    long long promotionCount() const { return promotions; }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const { queues.forEach(visit); }
+
+    void saveState(SnapshotWriter& out) const {
+        out.writeInt(currentTime);
+        out.writeInt(boostEpoch);
+        out.writeLong(boosts);
+        out.writeLong(promotions);
+    }
+
+    void loadState(SnapshotReader& in) {
+        currentTime = in.readInt();
+        boostEpoch = in.readInt();
+        boosts = in.readLong();
+        promotions = in.readLong();
+    }
+
+    // The slot is the physical level, which lags queueLevel after a boost.
+    // A configuration with fewer levels than the snapshot's keeps processes
+    // on its last level.
+    void restoreQueued(Process* process, int slot) {
+        restoreRunning(process);
+        if (slot < 0) {
+            enqueue(process);
+        }
+        else {
+            queues.push(process, std::min(slot, levels() - 1));
+        }
+    }
+
+    void restoreRunning(Process* process) const { process->queueLevel = std::min(process->queueLevel, levels()); }
+
+private:
+    int levels() const { return static_cast<int>(quanta.size()); }
+
+    // Applies any boost that happened since the process's level was last set
+    void refreshLevel(Process* process) const {
+        if (process->boostEpoch != boostEpoch) {
+            process->boostEpoch = boostEpoch;
+            process->queueLevel = 1;
+        }
+    }
+
+    void promoteAged() {
+        for (int level = queues.nextLevel(1); level != -1; level = queues.nextLevel(level + 1)) {
+            while (!queues.levelEmpty(level) && currentTime - queues.front(level)->queuedSince >= agingThreshold) {
+                Process* process = queues.pop(level);
+                process->queueLevel = level;   // One level up, 1-based
+                process->queuedSince = currentTime;
+                queues.push(process, level - 1);
+                promotions++;
+            }
+        }
+    }
+
+    std::vector<int> quanta;
+    int boostPeriod;
+    int agingThreshold;
+    MultilevelQueue queues;
+    int currentTime = 0;
+    int boostEpoch = 0;
+    long long boosts = 0;
+    long long promotions = 0;
+};
+
+// Non-preemptive priority scheduling on the nice value, FCFS among equals.
+// One run-queue level per nice value.
+class PriorityPolicy : public SchedulingPolicy<PriorityPolicy> {
+public:
+    static const char* snapshotName() { return "Priority"; }
+
+    bool empty() const { return readyQueue.empty(); }
+    void enqueue(Process* process) { readyQueue.push(process, std::min(19, std::max(-20, process->priority)) + 20); }
+    Process* pickNext() { return readyQueue.pop(); }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const { readyQueue.forEach(visit); }
+
+private:
+    MultilevelQueue readyQueue;
+};
+
+// Lottery scheduling: every quantum goes to a ready process drawn at random,
+// with odds proportional to the weight of its nice value.
+class LotteryPolicy : public SchedulingPolicy<LotteryPolicy> {
+public:
+    explicit LotteryPolicy(int quantum = 5, std::uint64_t seed = 1) : quantum(quantum), rng(seed) {}
+
+    static const char* snapshotName() { return "Lottery"; }
+
+    // The generator's state depends on every draw so far
+    bool forgetsWhenIdle() const { return false; }
+
+    int timeSlice(const Process& process) const { return std::min(process.remainingCpuTime, quantum); }
+
+    bool empty() const { return readyQueue.empty(); }
+
+    void enqueue(Process* process) {
+        readyQueue.push_back(process);
+        totalTickets += niceWeight(process->priority);
+    }
+
+    Process* pickNext() {
+        long long ticket = std::uniform_int_distribution<long long>(0, totalTickets - 1)(rng);
+        size_t winner = 0;
+        while (ticket >= niceWeight(readyQueue[winner]->priority)) {
+            ticket -= niceWeight(readyQueue[winner]->priority);
+            winner++;
+        }
+        Process* process = readyQueue[winner];
+        readyQueue[winner] = readyQueue.back();
+        readyQueue.pop_back();
+        totalTickets -= niceWeight(process->priority);
+        return process;
+    }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (Process* process : readyQueue) {
+            visit(process, 0);
+        }
+    }
+
+    void saveState(SnapshotWriter& out) const {
+        std::ostringstream engine;
+        engine << rng;
+        out.writeString(engine.str());
+    }
+
+    void loadState(SnapshotReader& in) {
+        std::istringstream engine(in.readString());
+        engine >> rng;
+        if (!engine) {
+            throw std::runtime_error("snapshot holds a corrupt lottery generator");
+        }
+    }
+
+private:
+    int quantum;
+    std::mt19937_64 rng;
+    std::vector<Process*> readyQueue;
+    long long totalTickets = 0;
+};
+
+// Completely fair scheduling: the process with the least weighted CPU time
+// runs next, for an equal share of the target latency. A process waking from
+// I/O has its virtual runtime raised to near the minimum, so sleeping does not
+// bank an unbounded claim on the CPU.
+class CfsPolicy : public SchedulingPolicy<CfsPolicy> {
+public:
+    explicit CfsPolicy(int targetLatency = 20, int minGranularity = 2)
+        : targetLatency(targetLatency), minGranularity(minGranularity) {}
+
+    static const char* snapshotName() { return "CFS"; }
+
+    // Later arrivals start from the minimum virtual runtime so far
+    bool forgetsWhenIdle() const { return false; }
+
+    int timeSlice(const Process& process) const {
+        int share = targetLatency / static_cast<int>(readyQueue.size() + 1);
+        return std::min(process.remainingCpuTime, std::max(minGranularity, share));
+    }
+
+    void onRan(Process* process, int time) {
+        process->virtualRuntime += static_cast<long long>(time) * niceWeight(0) / niceWeight(process->priority);
+    }
+
+    bool empty() const { return readyQueue.empty(); }
+
+    void enqueue(Process* process) {
+        long long floor = minVirtualRuntime - targetLatency / 2;
+        process->virtualRuntime = std::max(process->virtualRuntime, floor);
+        push(process);
+    }
+
+    Process* pickNext() {
+        std::pop_heap(readyQueue.begin(), readyQueue.end(), Later());
+        Process* process = readyQueue.back().process;
+        readyQueue.pop_back();
+        minVirtualRuntime = std::max(minVirtualRuntime, process->virtualRuntime);
+        return process;
+    }
+
+    void onQuantumExpired(Process* process) { push(process); }
+
+    template <typename Visit>
+    void forEachQueued(Visit&& visit) const {
+        for (const Entry& entry : readyQueue) {
+            visit(entry.process, 0);
+        }
+    }
+
+    void saveState(SnapshotWriter& out) const { out.writeLong(minVirtualRuntime); }
+    void loadState(SnapshotReader& in) { minVirtualRuntime = in.readLong(); }
+
+    // A queued process keeps the virtual runtime it was queued with
+    void restoreQueued(Process* process, int slot) {
+        if (slot < 0) {
+            enqueue(process);
+        }
+        else {
+            push(process);
+        }
+    }
+
+private:
+    struct Entry {
+        long long virtualRuntime;
+        int pid;
+        Process* process;
+    };
+
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.virtualRuntime != b.virtualRuntime) {
+                return a.virtualRuntime > b.virtualRuntime;
+            }
+            return a.pid > b.pid;
+        }
+    };
+
+    void push(Process* process) {
+        readyQueue.push_back({ process->virtualRuntime, process->pid, process });
+        std::push_heap(readyQueue.begin(), readyQueue.end(), Later());
+    }
+
+    int targetLatency;
+    int minGranularity;
+    std::vector<Entry> readyQueue;
+    long long minVirtualRuntime = 0;
+};
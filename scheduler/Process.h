@@ -0,0 +1,51 @@
+#pragma once
+
+#include <climits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+// Simulated times are ints, as traces, event logs and snapshots store them,
+// and INT_MAX stands for "never". Returns `time` as one, or throws once a run
+// would reach INT_MAX instead of wrapping.
+inline int simulatedTime(long long time) {
+    if (time >= INT_MAX) {
+        throw std::overflow_error("simulated time passes the 32-bit range");
+    }
+    return static_cast<int>(time);
+}
+
+struct Process {
+    int pid;
+    std::vector<int> cpuBursts;
+    std::vector<int> ioTimes;
+    int currentBurstIndex = 0;
+    int arrivalTime = 0;
+    int initialArrivalTime = 0; 
+    int waitingTime = 0;
+    int turnaroundTime = 0;
+    int responseTime = -1;
+    bool isCompleted = false;
+
+    int remainingCpuTime = 0;
+    int remainingIoTime = 0;
+
+    int queueLevel = 1;      
+    int timeSliceUsed = 0;   
+    int queuedSince = 0;     // Time the process entered its current MLFQ level
+    int boostEpoch = 0;      // MLFQ boost period its queueLevel was last valid in
+
+    int longestWait = 0;     // Longest single stretch spent ready but not running
+    int lastRanAt = -1;      // Time the process last left a CPU, -1 if it never ran
+
+    int heapIndex = -1;      // Position in a ReadyHeap, -1 when not queued
+    Process* nextInQueue = nullptr;  // Next process in the same MultilevelQueue level
+    int lastCore = -1;       // Core that last ran the process in a multi-core run
+
+    int priority = 0;              // Nice value: -20 is most favoured, 19 least
+    long long virtualRuntime = 0;  // Weighted CPU time, for the CFS policy
+
+    Process(int id, std::vector<int> cpu, std::vector<int> io)
+        : pid(id), cpuBursts(std::move(cpu)), ioTimes(std::move(io)) {}
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Process.h"
+
+
+// Slab allocator for the processes an arrival source hands out. Processes are
+// constructed a slab at a time and recycled through a free list threaded
+// through Process::nextInQueue, which is unused while a process is free. A
+// recycled process keeps the capacity of its burst vectors, so once the pool
+// has grown to the peak number of live processes, and their vectors to the
+// longest burst list, admitting and retiring processes never touches the heap.
+//
+// Each slab is as large as the pool was before it, so there are only
+// logarithmically many. Slabs are never moved or freed before the pool is,
+// so a pointer from acquire() stays valid until the pool is destroyed.
+class ProcessPool {
+public:
+    explicit ProcessPool(size_t firstSlab = 64) : firstSlab(firstSlab > 0 ? firstSlab : 1) {}
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    // A process as Process(pid, {}, {}) would construct it, bursts included.
+    Process* acquire(int pid) {
+        if (freeList == nullptr) {
+            addSlab();
+        }
+        Process* process = freeList;
+        freeList = process->nextInQueue;
+        std::vector<int> cpu = std::move(process->cpuBursts);
+        std::vector<int> io = std::move(process->ioTimes);
+        cpu.clear();
+        io.clear();
+        *process = Process(pid, std::move(cpu), std::move(io));
+        live++;
+        return process;
+    }
+
+    // Moves an existing process into the pool, as when restoring a snapshot.
+    Process* adopt(Process process) {
+        Process* pooled = acquire(process.pid);
+        *pooled = std::move(process);
+        pooled->nextInQueue = nullptr;
+        return pooled;
+    }
+
+    // Hands a process from acquire() back for reuse.
+    void release(Process* process) {
+        process->nextInQueue = freeList;
+        freeList = process;
+        live--;
+    }
+
+    // True if the process came from this pool.
+    bool owns(const Process* process) const {
+        std::less<const Process*> before;
+        for (const std::vector<Process>& slab : slabs) {
+            if (!before(process, slab.data()) && before(process, slab.data() + slab.size())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Grows the pool up front so the first `count` live processes need no allocation.
+    void reserve(size_t count) {
+        while (total < count) {
+            addSlab();
+        }
+    }
+
+    size_t size() const { return live; }
+    size_t capacity() const { return total; }
+
+private:
+    void addSlab() {
+        size_t slabSize = total > 0 ? total : firstSlab;
+        slabs.emplace_back();
+        std::vector<Process>& slab = slabs.back();
+        slab.reserve(slabSize);
+        for (size_t i = 0; i < slabSize; ++i) {
+            slab.emplace_back(0, std::vector<int>(), std::vector<int>());
+        }
+        // Thread the free list backwards so processes are handed out in address order
+        for (size_t i = slabSize; i-- > 0;) {
+            slab[i].nextInQueue = freeList;
+            freeList = &slab[i];
+        }
+        total += slabSize;
+    }
+
+    size_t firstSlab;
+    std::vector<std::vector<Process>> slabs;
+    Process* freeList = nullptr;
+    size_t total = 0;
+    size_t live = 0;
+};
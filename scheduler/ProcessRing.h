@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Process.h"
+
+
+// FIFO of processes in a power-of-two ring buffer. Unlike std::queue, which
+// allocates and frees deque blocks as it slides, the ring only allocates when
+// it outgrows its capacity, so a simulation stops allocating once its queues
+// have reached their peak length.
+class ProcessRing {
+public:
+    explicit ProcessRing(size_t initialCapacity = 16) {
+        size_t capacity = 1;
+        while (capacity < initialCapacity) {
+            capacity *= 2;
+        }
+        slots.resize(capacity);
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    Process* front() const { return slots[head]; }
+
+    // The i-th process from the front.
+    Process* at(size_t i) const { return slots[(head + i) & (slots.size() - 1)]; }
+
+    void push(Process* process) {
+        if (count == slots.size()) {
+            grow();
+        }
+        slots[(head + count) & (slots.size() - 1)] = process;
+        count++;
+    }
+
+    void pop() {
+        head = (head + 1) & (slots.size() - 1);
+        count--;
+    }
+
+private:
+    void grow() {
+        std::vector<Process*> larger(slots.size() * 2);
+        for (size_t i = 0; i < count; ++i) {
+            larger[i] = slots[(head + i) & (slots.size() - 1)];
+        }
+        slots.swap(larger);
+        head = 0;
+    }
+
+    std::vector<Process*> slots;
+    size_t head = 0;
+    size_t count = 0;
+};
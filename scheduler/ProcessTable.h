@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Process.h"
+
+
+using ProcessIndex = std::uint32_t;
+
+// A run of bursts inside ProcessTable::bursts.
+struct BurstRange {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+// Struct-of-arrays alternative to a collection of Process objects. Every burst
+// of every process lives in one contiguous arena and is addressed through an
+// offset/length pair, and each per-process field is its own array indexed by
+// a 32-bit ProcessIndex. A scheduler touching remainingCpuTime for many
+// processes walks one dense array instead of one heap object per process.
+//
+// This is a layout experiment: no scheduler, engine or arrival source runs on
+// the table. Only bench/ProcessTableBench.cpp uses it, on a synthetic loop
+// that mimics a scheduler's access pattern, so its figures say how the two
+// layouts compare, not how a real scheduling run would change.
+struct ProcessTable {
+    // Burst arena: a process's CPU bursts are immediately followed by its I/O times
+    std::vector<int> bursts;
+    std::vector<BurstRange> cpuBursts;
+    std::vector<BurstRange> ioTimes;
+
+    // Hot scheduling state
+    std::vector<int> remainingCpuTime;
+    std::vector<int> arrivalTime;
+    std::vector<int> queueLevel;
+    std::vector<int> timeSliceUsed;
+    std::vector<int> currentBurstIndex;
+    std::vector<int> remainingIoTime;
+
+    // Identity and results, only touched on arrival, dispatch and completion
+    std::vector<int> pid;
+    std::vector<int> initialArrivalTime;
+    std::vector<int> waitingTime;
+    std::vector<int> turnaroundTime;
+    std::vector<int> responseTime;
+
+    size_t size() const { return pid.size(); }
+
+    void reserve(size_t processCount, size_t burstCount) {
+        bursts.reserve(burstCount);
+        forEachColumn(*this, [processCount](std::vector<int>& column) { column.reserve(processCount); });
+        cpuBursts.reserve(processCount);
+        ioTimes.reserve(processCount);
+    }
+
+    ProcessIndex add(int id, const int* cpu, size_t cpuCount, const int* io, size_t ioCount,
+                     int initialArrival = 0) {
+        ProcessIndex index = static_cast<ProcessIndex>(pid.size());
+        cpuBursts.push_back({ static_cast<std::uint32_t>(bursts.size()), static_cast<std::uint32_t>(cpuCount) });
+        bursts.insert(bursts.end(), cpu, cpu + cpuCount);
+        ioTimes.push_back({ static_cast<std::uint32_t>(bursts.size()), static_cast<std::uint32_t>(ioCount) });
+        bursts.insert(bursts.end(), io, io + ioCount);
+
+        remainingCpuTime.push_back(cpuCount > 0 ? cpu[0] : 0);
+        arrivalTime.push_back(initialArrival);
+        queueLevel.push_back(1);
+        timeSliceUsed.push_back(0);
+        currentBurstIndex.push_back(0);
+        remainingIoTime.push_back(0);
+
+        pid.push_back(id);
+        initialArrivalTime.push_back(initialArrival);
+        waitingTime.push_back(0);
+        turnaroundTime.push_back(0);
+        responseTime.push_back(-1);
+        return index;
+    }
+
+    ProcessIndex add(const Process& process) {
+        return add(process.pid, process.cpuBursts.data(), process.cpuBursts.size(),
+            process.ioTimes.data(), process.ioTimes.size(), process.initialArrivalTime);
+    }
+
+    int cpuBurst(ProcessIndex index, int burst) const {
+        return bursts[cpuBursts[index].offset + burst];
+    }
+
+    int ioTime(ProcessIndex index, int burst) const {
+        return bursts[ioTimes[index].offset + burst];
+    }
+
+    int cpuBurstCount(ProcessIndex index) const { return static_cast<int>(cpuBursts[index].length); }
+    int ioBurstCount(ProcessIndex index) const { return static_cast<int>(ioTimes[index].length); }
+
+    // Bytes reserved by the table, including unused vector capacity.
+    size_t memoryFootprint() const {
+        size_t total = bursts.capacity() * sizeof(int)
+            + (cpuBursts.capacity() + ioTimes.capacity()) * sizeof(BurstRange);
+        forEachColumn(*this, [&total](const std::vector<int>& column) { total += column.capacity() * sizeof(int); });
+        return total;
+    }
+
+private:
+    template <typename Table, typename Visit>
+    static void forEachColumn(Table& table, Visit&& visit) {
+        for (auto* column : { &table.remainingCpuTime, &table.arrivalTime, &table.queueLevel, &table.timeSliceUsed,
+                              &table.currentBurstIndex, &table.remainingIoTime, &table.pid,
+                              &table.initialArrivalTime, &table.waitingTime, &table.turnaroundTime,
+                              &table.responseTime }) {
+            visit(*column);
+        }
+    }
+};
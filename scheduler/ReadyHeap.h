@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Process.h"
+
+
+// Ready queue for the shortest-job policies: a 4-ary min-heap of processes
+// ordered on (remainingCpuTime, pid). Each process records its own slot in
+// heapIndex, so its key can be lowered in place while it sits in the heap.
+class ReadyHeap {
+public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    Process* top() const { return heap.front(); }
+
+    // Processes in heap order, which is not pick order.
+    Process* at(size_t i) const { return heap[i]; }
+
+    void push(Process* process) {
+        heap.push_back(process);
+        siftUp(heap.size() - 1);
+    }
+
+    Process* pop() {
+        Process* front = heap.front();
+        front->heapIndex = -1;
+        Process* last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return front;
+    }
+
+    // Pops the top and pushes `process` in a single sift.
+    Process* replaceTop(Process* process) {
+        Process* front = heap.front();
+        front->heapIndex = -1;
+        heap[0] = process;
+        siftDown(0);
+        return front;
+    }
+
+    // Takes a process out of the heap from wherever it sits.
+    void remove(Process* process) {
+        size_t index = static_cast<size_t>(process->heapIndex);
+        process->heapIndex = -1;
+        Process* last = heap.back();
+        heap.pop_back();
+        if (index < heap.size()) {
+            heap[index] = last;
+            siftUp(index);
+            siftDown(static_cast<size_t>(last->heapIndex));
+        }
+    }
+
+    // Restores heap order after process->remainingCpuTime has been lowered.
+    void decreaseKey(Process* process) {
+        siftUp(process->heapIndex);
+    }
+
+    static bool before(const Process* a, const Process* b) {
+        if (a->remainingCpuTime != b->remainingCpuTime) {
+            return a->remainingCpuTime < b->remainingCpuTime;
+        }
+        // Tie-breaker: select process with lower PID
+        return a->pid < b->pid;
+    }
+
+private:
+    static const size_t Arity = 4;
+
+    void place(size_t index, Process* process) {
+        heap[index] = process;
+        process->heapIndex = static_cast<int>(index);
+    }
+
+    void siftUp(size_t index) {
+        Process* process = heap[index];
+        while (index > 0) {
+            size_t parent = (index - 1) / Arity;
+            if (!before(process, heap[parent])) {
+                break;
+            }
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, process);
+    }
+
+    void siftDown(size_t index) {
+        Process* process = heap[index];
+        for (;;) {
+            size_t first = index * Arity + 1;
+            if (first >= heap.size()) {
+                break;
+            }
+            size_t last = std::min(first + Arity, heap.size());
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (before(heap[child], heap[best])) {
+                    best = child;
+                }
+            }
+            if (!before(heap[best], process)) {
+                break;
+            }
+            place(index, heap[best]);
+            index = best;
+        }
+        place(index, process);
+    }
+
+    std::vector<Process*> heap;
+};
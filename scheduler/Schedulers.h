@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "Engine.h"
+#include "Policies.h"
+#include "Process.h"
+#include "Statistics.h"
+#include "TraceSink.h"
+
+
+inline void validateMlfqConfig(const MlfqConfig& config) {
+    if (!config.valid()) {
+        throw std::invalid_argument("MLFQ needs at least one level, positive quanta above the last level and non-negative boost and aging times");
+    }
+}
+
+inline SchedulerResult schedulerFunction(ArrivalSource& arrivals, TraceSink& trace = standardOutputTrace()) {
+    return runEngine(arrivals, FcfsPolicy(), trace);
+}
+
+inline SchedulerResult SJFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace = standardOutputTrace()) {
+    return runEngine(arrivals, SjfPolicy(), trace);
+}
+
+inline SchedulerResult SRTFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace = standardOutputTrace()) {
+    return runEngine(arrivals, SrtfPolicy(), trace);
+}
+
+inline SchedulerResult mlfqScheduler(ArrivalSource& arrivals, const MlfqConfig& config, TraceSink& trace = standardOutputTrace()) {
+    validateMlfqConfig(config);
+    return runEngine(arrivals, MlfqPolicy(config), trace);
+}
+
+inline SchedulerResult mlfqScheduler(ArrivalSource& arrivals, TraceSink& trace = standardOutputTrace()) {
+    return mlfqScheduler(arrivals, MlfqConfig(), trace);
+}
+
+// The same schedulers, also collecting latency and queue statistics.
+inline SchedulerResult schedulerFunction(ArrivalSource& arrivals, TraceSink& trace, SimulationStatistics& statistics) {
+    return runEngine(arrivals, FcfsPolicy(), trace, statistics);
+}
+
+inline SchedulerResult SJFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace, SimulationStatistics& statistics) {
+    return runEngine(arrivals, SjfPolicy(), trace, statistics);
+}
+
+inline SchedulerResult SRTFschedulerFunction(ArrivalSource& arrivals, TraceSink& trace, SimulationStatistics& statistics) {
+    return runEngine(arrivals, SrtfPolicy(), trace, statistics);
+}
+
+inline SchedulerResult mlfqScheduler(ArrivalSource& arrivals, const MlfqConfig& config, TraceSink& trace,
+                                     SimulationStatistics& statistics) {
+    validateMlfqConfig(config);
+    return runEngine(arrivals, MlfqPolicy(config), trace, statistics);
+}
+
+// Convenience overloads for a fixed workload whose processes all exist up front.
+inline SchedulerResult schedulerFunction(std::vector<Process*>& processes, TraceSink& trace = standardOutputTrace()) {
+    VectorArrivalSource arrivals(processes);
+    return schedulerFunction(arrivals, trace);
+}
+
+inline SchedulerResult SJFschedulerFunction(std::vector<Process*>& processes, TraceSink& trace = standardOutputTrace()) {
+    VectorArrivalSource arrivals(processes);
+    return SJFschedulerFunction(arrivals, trace);
+}
+
+inline SchedulerResult SRTFschedulerFunction(std::vector<Process*>& processes, TraceSink& trace = standardOutputTrace()) {
+    VectorArrivalSource arrivals(processes);
+    return SRTFschedulerFunction(arrivals, trace);
+}
+
+inline SchedulerResult mlfqScheduler(std::vector<Process*>& processes, TraceSink& trace = standardOutputTrace()) {
+    VectorArrivalSource arrivals(processes);
+    return mlfqScheduler(arrivals, trace);
+}
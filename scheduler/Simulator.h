@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "CostModel.h"
+#include "Engine.h"
+#include "Process.h"
+#include "ProcessPool.h"
+#include "Snapshot.h"
+#include "Statistics.h"
+#include "TraceSink.h"
+
+
+// Arrival source fed at run time. Processes may be submitted in any order;
+// they are admitted by arrival time, in submission order among equal times.
+// Submitted pointers stay the caller's; processes submitted by value (and any
+// a snapshot restores) live in the source's pool and return to it after the
+// retire callback.
+class OnlineArrivalSource : public ArrivalSource {
+public:
+    explicit OnlineArrivalSource(std::function<void(const Process&)> onRetire = nullptr)
+        : retired(std::move(onRetire)) {}
+
+    // Moves a process submitted by value into the pool.
+    Process* take(Process process) { return pool.adopt(std::move(process)); }
+
+    void submit(Process* process) {
+        if (isClosed) {
+            release(process);
+            throw std::logic_error("processes cannot be submitted after the simulator was closed");
+        }
+        if (process->initialArrivalTime == INT_MAX) {
+            release(process);
+            throw std::overflow_error("arrival time passes the 32-bit range");
+        }
+        pending.push({ process->initialArrivalTime, nextSequence++, process });
+        submitted++;
+    }
+
+    void close() { isClosed = true; }
+    long long submittedCount() const { return submitted; }
+    size_t pendingCount() const { return pending.size(); }
+
+    int nextArrivalTime() override { return pending.empty() ? INT_MAX : pending.top().arrival; }
+
+    Process* admit() override {
+        Process* process = pending.top().process;
+        pending.pop();
+        return process;
+    }
+
+    void retire(Process* process) override {
+        if (retired) {
+            retired(*process);
+        }
+        release(process);
+    }
+
+    bool closed() const override { return isClosed; }
+
+    // Not-yet-admitted processes travel in the snapshot; they come back owned.
+    void saveState(SnapshotWriter& out) const override {
+        out.writeInt(isClosed ? 1 : 0);
+        out.writeLong(submitted);
+        std::vector<Entry> waiting = pendingInOrder();
+        out.writeSize(waiting.size());
+        for (const Entry& entry : waiting) {
+            out.writeProcess(*entry.process);
+        }
+    }
+
+    void loadState(SnapshotReader& in) override {
+        while (!pending.empty()) {
+            release(pending.top().process);
+            pending.pop();
+        }
+        isClosed = in.readInt() != 0;
+        long long total = in.readLong();
+        for (std::uint64_t count = in.readSize(); count > 0; --count) {
+            Process* process = restoreProcess(in.readProcess());
+            pending.push({ process->initialArrivalTime, nextSequence++, process });
+        }
+        submitted = total;
+    }
+
+    Process* restoreProcess(Process saved) override { return pool.adopt(std::move(saved)); }
+
+private:
+    struct Entry {
+        int arrival;
+        unsigned long long sequence;
+        Process* process;
+    };
+
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.arrival != b.arrival) {
+                return a.arrival > b.arrival;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    void release(Process* process) {
+        if (pool.owns(process)) {
+            pool.release(process);
+        }
+    }
+
+    std::vector<Entry> pendingInOrder() const {
+        std::priority_queue<Entry, std::vector<Entry>, Later> copy(pending);
+        std::vector<Entry> ordered;
+        ordered.reserve(copy.size());
+        while (!copy.empty()) {
+            ordered.push_back(copy.top());
+            copy.pop();
+        }
+        return ordered;
+    }
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> pending;
+    ProcessPool pool;
+    std::function<void(const Process&)> retired;
+    unsigned long long nextSequence = 0;
+    long long submitted = 0;
+    bool isClosed = false;
+};
+
+// Point-in-time view of a running simulation. Latency percentiles and the
+// time series are on Simulator::statistics().
+struct SimulatorMetrics {
+    int now = 0;
+    long long completed = 0;
+    int readyQueueLength = 0;
+    bool cpuBusy = false;
+    long long totalCpuTime = 0;
+    long long overheadTime = 0;    // Time spent switching processes in
+    double cpuUtilization = 0.0;   // Percentage of `now` spent running bursts
+};
+
+// Stepping interface over the engine for callers that interleave simulation
+// with other work, such as a service feeding live arrivals. Any policy from
+// Policies.h can drive it. Work per call is bounded by the number of
+// scheduling decisions it makes: step() makes one, advanceUntil() those due up
+// to a time, optionally capped, and metrics() reads running totals.
+//
+// An online simulator takes processes through submit() and stays open, idling
+// when it runs out of work, until close(). A simulator over an ArrivalSource
+// replays that workload and ends when it is exhausted.
+class Simulator {
+public:
+    template <typename Policy>
+    explicit Simulator(Policy policy, std::function<void(const Process&)> onRetire = nullptr)
+        : Simulator(std::move(policy), discard, std::move(onRetire)) {}
+
+    template <typename Policy>
+    Simulator(Policy policy, TraceSink& trace, std::function<void(const Process&)> onRetire = nullptr)
+        : online(new OnlineArrivalSource(std::move(onRetire))),
+          core(new EngineCore<Policy>(*online, std::move(policy), trace, collected)) {}
+
+    template <typename Policy>
+    Simulator(Policy policy, ArrivalSource& workload, TraceSink& trace)
+        : core(new EngineCore<Policy>(workload, std::move(policy), trace, collected)) {}
+
+    Simulator(const Simulator&) = delete;
+    Simulator& operator=(const Simulator&) = delete;
+
+    // Queues a process to arrive at its initialArrivalTime, or now if that has
+    // passed. The simulator takes ownership of processes submitted by value.
+    void submit(Process* process) {
+        requireOnline();
+        enqueue(process);
+    }
+
+    void submit(Process process) {
+        requireOnline();
+        enqueue(online->take(std::move(process)));
+    }
+
+    // No more submissions; the run ends once the submitted work is done.
+    void close() {
+        if (online) {
+            online->close();
+        }
+    }
+
+    // Charges dispatches under `model` from now on (see CostModel).
+    void setCostModel(const CostModel& model) { core->setCostModel(model); }
+
+    // Makes one scheduling decision. False when there is nothing to do until
+    // more processes are submitted, or once the run has ended.
+    bool step() {
+        core->setHorizon(INT_MAX);
+        return core->step();
+    }
+
+    // Simulates everything that happens before `time`, making at most maxSteps
+    // decisions, and leaves the clock at `time` unless the run has ended. A
+    // process running at `time` is paused there, not preempted, so processes
+    // submitted for `time` afterwards are scheduled exactly as if they had
+    // been known from the start. Returns false if maxSteps ran out first.
+    bool advanceUntil(int time, long long maxSteps = LLONG_MAX) {
+        core->setHorizon(time);
+        for (long long steps = 0; !core->done() && core->nextDecisionTime() < time; ++steps) {
+            if (steps == maxSteps) {
+                return false;
+            }
+            if (!core->step()) {
+                break;
+            }
+        }
+        core->idleUntil(time);
+        return true;
+    }
+
+    // Closes submissions and runs to the end.
+    SchedulerResult runToCompletion() {
+        close();
+        core->setHorizon(INT_MAX);
+        while (core->step()) {
+        }
+        return core->result();
+    }
+
+    int now() const { return core->now(); }
+    bool done() const { return core->done(); }
+    SchedulerResult result() const { return core->result(); }
+    const SimulationStatistics& statistics() const { return collected; }
+
+    SimulatorMetrics metrics() const {
+        SimulatorMetrics snapshot;
+        snapshot.now = core->now();
+        snapshot.completed = collected.waiting().count();
+        snapshot.readyQueueLength = collected.readyQueueLength();
+        snapshot.cpuBusy = core->busy();
+        SchedulerResult totals = core->result();
+        snapshot.totalCpuTime = totals.totalCpuTime;
+        snapshot.overheadTime = totals.overheadTime;
+        snapshot.cpuUtilization = snapshot.now > 0 ? 100.0 * snapshot.totalCpuTime / snapshot.now : 0.0;
+        return snapshot;
+    }
+
+    // See Engine::save and Engine::load.
+    void checkpoint(const std::string& path) const {
+        SnapshotWriter out;
+        core->save(out);
+        out.save(path);
+    }
+
+    void restore(const std::string& path) {
+        SnapshotFile file(path);
+        SnapshotReader in = file.reader();
+        core->load(in);
+    }
+
+private:
+    struct Core {
+        virtual ~Core() = default;
+        virtual bool step() = 0;
+        virtual bool done() const = 0;
+        virtual bool busy() const = 0;
+        virtual int now() const = 0;
+        virtual int nextDecisionTime() const = 0;
+        virtual void idleUntil(int time) = 0;
+        virtual void refreshArrivals() = 0;
+        virtual void setHorizon(int time) = 0;
+        virtual void setCostModel(const CostModel& model) = 0;
+        virtual SchedulerResult result() const = 0;
+        virtual void save(SnapshotWriter& out) const = 0;
+        virtual void load(SnapshotReader& in) = 0;
+    };
+
+    template <typename Policy>
+    struct EngineCore : Core {
+        EngineCore(ArrivalSource& arrivals, Policy policy, TraceSink& trace, SimulationStatistics& statistics)
+            : engine(arrivals, std::move(policy), trace, statistics) {}
+
+        bool step() override { return engine.step(); }
+        bool done() const override { return engine.done(); }
+        bool busy() const override { return engine.runningProcess() != nullptr; }
+        int now() const override { return engine.now(); }
+        int nextDecisionTime() const override { return engine.nextDecisionTime(); }
+        void idleUntil(int time) override { engine.idleUntil(time); }
+        void refreshArrivals() override { engine.refreshArrivals(); }
+        void setHorizon(int time) override { engine.setHorizon(time); }
+        void setCostModel(const CostModel& model) override { engine.setCostModel(model); }
+        SchedulerResult result() const override { return engine.result(); }
+        void save(SnapshotWriter& out) const override { engine.save(out); }
+        void load(SnapshotReader& in) override { engine.load(in); }
+
+        Engine<Policy, SimulationStatistics&> engine;
+    };
+
+    void requireOnline() const {
+        if (!online) {
+            throw std::logic_error("processes can only be submitted to an online simulator");
+        }
+    }
+
+    void enqueue(Process* process) {
+        process->initialArrivalTime = std::max(process->initialArrivalTime, core->now());
+        online->submit(process);
+        core->refreshArrivals();
+    }
+
+    NullTraceSink discard;
+    SimulationStatistics collected;
+    std::unique_ptr<OnlineArrivalSource> online;
+    std::unique_ptr<Core> core;
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ByteOrder.h"
+#include "MappedFile.h"
+#include "Process.h"
+
+
+// Checkpoints of a simulation in progress (see Engine::save). A snapshot file
+// is the 8-byte magic "CPUSNAPS", a uint32 version and a uint32 reserved word,
+// followed by sections each component writes and reads back in the same
+// order. Integers are little-endian and unaligned; a snapshot is read straight
+// out of a read-only mapping of the file.
+static const char SnapshotMagic[8] = { 'C', 'P', 'U', 'S', 'N', 'A', 'P', 'S' };
+static const std::uint32_t SnapshotVersion = 3;
+
+class SnapshotWriter {
+public:
+    void writeInt(std::int32_t value) {
+        char word[4];
+        storeLittle32(word, static_cast<std::uint32_t>(value));
+        append(word, sizeof(word));
+    }
+
+    void writeLong(std::int64_t value) { writeSize(static_cast<std::uint64_t>(value)); }
+
+    void writeSize(std::uint64_t value) {
+        char word[8];
+        storeLittle64(word, value);
+        append(word, sizeof(word));
+    }
+
+    void writeString(const std::string& text) {
+        writeSize(text.size());
+        append(text.data(), text.size());
+    }
+
+    // A length-prefixed block, so a reader that does not understand it can skip it.
+    void writeSection(const SnapshotWriter& section) {
+        writeSize(section.bytes.size());
+        append(section.bytes.data(), section.bytes.size());
+    }
+
+    // Every field of the process a run depends on. Queue links are not
+    // written; the owning structure rebuilds them on restore.
+    void writeProcess(const Process& process) {
+        writeInt(process.pid);
+        writeInt(process.currentBurstIndex);
+        writeInt(process.arrivalTime);
+        writeInt(process.initialArrivalTime);
+        writeInt(process.waitingTime);
+        writeInt(process.turnaroundTime);
+        writeInt(process.responseTime);
+        writeInt(process.isCompleted ? 1 : 0);
+        writeInt(process.remainingCpuTime);
+        writeInt(process.remainingIoTime);
+        writeInt(process.queueLevel);
+        writeInt(process.timeSliceUsed);
+        writeInt(process.queuedSince);
+        writeInt(process.boostEpoch);
+        writeInt(process.longestWait);
+        writeInt(process.lastCore);
+        writeInt(process.lastRanAt);
+        writeInt(process.priority);
+        writeLong(process.virtualRuntime);
+        writeInts(process.cpuBursts);
+        writeInts(process.ioTimes);
+    }
+
+    void save(const std::string& path) const {
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), std::fclose);
+        if (!file) {
+            throw std::runtime_error("cannot create " + path);
+        }
+        char header[8];
+        storeLittle32(header, SnapshotVersion);
+        storeLittle32(header + 4, 0);
+        bool written = std::fwrite(SnapshotMagic, 1, sizeof(SnapshotMagic), file.get()) == sizeof(SnapshotMagic)
+            && std::fwrite(header, sizeof(header), 1, file.get()) == 1
+            && std::fwrite(bytes.data(), 1, bytes.size(), file.get()) == bytes.size();
+        if (!written) {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+
+private:
+    void writeInts(const std::vector<int>& values) {
+        writeSize(values.size());
+        for (int value : values) {
+            writeInt(value);
+        }
+    }
+
+    void append(const void* data, size_t size) {
+        const char* first = static_cast<const char*>(data);
+        bytes.insert(bytes.end(), first, first + size);
+    }
+
+    std::vector<char> bytes;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+    bool atEnd() const { return cursor == end; }
+
+    std::int32_t readInt() { return static_cast<std::int32_t>(loadLittle32(take(4))); }
+    std::int64_t readLong() { return static_cast<std::int64_t>(readSize()); }
+    std::uint64_t readSize() { return loadLittle64(take(8)); }
+
+    std::string readString() {
+        std::uint64_t size = readSize();
+        require(size);
+        std::string text(cursor, static_cast<size_t>(size));
+        cursor += size;
+        return text;
+    }
+
+    SnapshotReader readSection() {
+        std::uint64_t size = readSize();
+        require(size);
+        SnapshotReader section(cursor, cursor + size);
+        cursor += size;
+        return section;
+    }
+
+    Process readProcess() {
+        Process process(readInt(), {}, {});
+        process.currentBurstIndex = readInt();
+        process.arrivalTime = readInt();
+        process.initialArrivalTime = readInt();
+        process.waitingTime = readInt();
+        process.turnaroundTime = readInt();
+        process.responseTime = readInt();
+        process.isCompleted = readInt() != 0;
+        process.remainingCpuTime = readInt();
+        process.remainingIoTime = readInt();
+        process.queueLevel = readInt();
+        process.timeSliceUsed = readInt();
+        process.queuedSince = readInt();
+        process.boostEpoch = readInt();
+        process.longestWait = readInt();
+        process.lastCore = readInt();
+        process.lastRanAt = readInt();
+        process.priority = readInt();
+        process.virtualRuntime = readLong();
+        readInts(process.cpuBursts);
+        readInts(process.ioTimes);
+        if (!consistent(process)) {
+            throw std::runtime_error("snapshot holds an inconsistent process " + std::to_string(process.pid));
+        }
+        return process;
+    }
+
+private:
+    void require(std::uint64_t size) const {
+        if (static_cast<std::uint64_t>(end - cursor) < size) {
+            throw std::runtime_error("truncated snapshot");
+        }
+    }
+
+    // Steps over the next size bytes, returning where they start.
+    const char* take(size_t size) {
+        require(size);
+        const char* bytes = cursor;
+        cursor += size;
+        return bytes;
+    }
+
+    void readInts(std::vector<int>& values) {
+        std::uint64_t count = readSize();
+        if (count > static_cast<std::uint64_t>(end - cursor) / sizeof(std::int32_t)) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        values.resize(static_cast<size_t>(count));
+        for (int& value : values) {
+            value = readInt();
+        }
+    }
+
+    // Whether the saved state is one a run can reach: the burst index within
+    // the bursts, at most one I/O after each burst, the CPU time left no more
+    // than the current burst (none once past the last) and an MLFQ level of
+    // at least 1. Policies clamp the level to their own number of levels.
+    static bool consistent(const Process& process) {
+        size_t bursts = process.cpuBursts.size();
+        if (bursts == 0 || process.ioTimes.size() > bursts || process.currentBurstIndex < 0
+            || static_cast<size_t>(process.currentBurstIndex) > bursts || process.queueLevel < 1) {
+            return false;
+        }
+        size_t burst = static_cast<size_t>(process.currentBurstIndex);
+        int burstLeft = burst < bursts ? process.cpuBursts[burst] : 0;
+        return process.remainingCpuTime >= 0 && process.remainingCpuTime <= burstLeft;
+    }
+
+    const char* cursor;
+    const char* end;
+};
+
+// A snapshot file mapped read-only, positioned after its header.
+class SnapshotFile {
+public:
+    explicit SnapshotFile(const std::string& path) : file(path) {
+        if (file.size() < sizeof(SnapshotMagic) + 8 || std::memcmp(file.data(), SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+            throw std::runtime_error(path + ": not a snapshot");
+        }
+        std::uint32_t version = loadLittle32(file.data() + sizeof(SnapshotMagic));
+        if (version != SnapshotVersion) {
+            throw std::runtime_error(path + ": unsupported snapshot version");
+        }
+    }
+
+    SnapshotReader reader() const {
+        return SnapshotReader(file.data() + sizeof(SnapshotMagic) + 8, file.data() + file.size());
+    }
+
+private:
+    MappedFile file;
+};
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Process.h"
+
+
+// Statistics hooks the engine calls as a run progresses. This one does
+// nothing and is the engine's default, so runs that do not ask for statistics
+// (the benchmarks among them) compile the collection out entirely.
+struct NoStatistics {
+    void readied(int) {}                    // A process joined the ready queue at the given time
+    void dispatched(int) {}                 // A process left the ready queue to run
+    void completed(const Process&, int) {}  // A process finished its last burst
+    void finished(int) {}                   // The run ended
+};
+
+// Log-linear histogram of non-negative integers in the style of HdrHistogram.
+// Values below 128 are counted exactly; above that each power of two is split
+// into 64 buckets, so any reported value is within 1/64 (about 1.6%) of the
+// true one. Memory is fixed whatever the number or range of values.
+class LatencyHistogram {
+public:
+    void record(int value) {
+        value = std::max(value, 0);
+        buckets[bucketOf(value)]++;
+        total++;
+        sum += value;
+        smallest = std::min(smallest, value);
+        largest = std::max(largest, value);
+    }
+
+    long long count() const { return total; }
+    int min() const { return total > 0 ? smallest : 0; }
+    int max() const { return largest; }
+    double mean() const { return total > 0 ? static_cast<double>(sum) / total : 0.0; }
+
+    // Smallest recorded value (to histogram precision) with at least p percent
+    // of the values at or below it, p in (0, 100].
+    int percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        long long rank = std::max<long long>(1, static_cast<long long>(std::ceil(p / 100.0 * total)));
+        long long seen = 0;
+        for (int bucket = 0; bucket < Buckets; ++bucket) {
+            seen += buckets[bucket];
+            if (seen >= rank) {
+                return std::min(highestIn(bucket), largest);
+            }
+        }
+        return largest;
+    }
+
+private:
+    static const int SubBuckets = 128;
+    static const int HalfSubBuckets = SubBuckets / 2;
+    static const int Buckets = SubBuckets + (31 - 7) * HalfSubBuckets;
+
+    static int highestBit(int value) {
+        int bit = 0;
+        while (value >> (bit + 1)) {
+            bit++;
+        }
+        return bit;
+    }
+
+    static int bucketOf(int value) {
+        if (value < SubBuckets) {
+            return value;
+        }
+        int shift = highestBit(value) - 6;
+        return SubBuckets + (shift - 1) * HalfSubBuckets + ((value >> shift) - HalfSubBuckets);
+    }
+
+    static int highestIn(int bucket) {
+        if (bucket < SubBuckets) {
+            return bucket;
+        }
+        int shift = (bucket - SubBuckets) / HalfSubBuckets + 1;
+        long long low = static_cast<long long>((bucket - SubBuckets) % HalfSubBuckets + HalfSubBuckets) << shift;
+        return static_cast<int>(std::min<long long>(low + (1LL << shift) - 1, INT_MAX));
+    }
+
+    long long buckets[Buckets] = {};
+    long long total = 0;
+    long long sum = 0;
+    int smallest = INT_MAX;
+    int largest = 0;
+};
+
+// Per-window totals and peaks over simulated time in a fixed number of
+// windows. When the run outgrows them, neighbouring windows are merged and
+// the window width doubles, so memory stays constant however long it runs.
+class WindowedSeries {
+public:
+    explicit WindowedSeries(int windowWidth = 100, int capacity = 512)
+        : width(std::max(1, windowWidth)), totals(std::max(2, capacity)), peaks(totals.size()) {}
+
+    // Adds amount to the window containing time.
+    void add(int time, double amount) {
+        totals[windowOf(time)] += amount;
+    }
+
+    // Adds level * (overlap with [from, to)) to every window the span touches.
+    void addSpan(int from, int to, double level) {
+        if (to <= from || level == 0.0) {
+            return;
+        }
+        windowOf(to - 1);
+        for (long long start = from; start < to;) {
+            size_t window = static_cast<size_t>(start / width);
+            long long end = std::min<long long>(to, (window + 1) * static_cast<long long>(width));
+            totals[window] += level * (end - start);
+            start = end;
+        }
+    }
+
+    void observePeak(int time, int value) {
+        int& peak = peaks[windowOf(time)];
+        peak = std::max(peak, value);
+    }
+
+    int windowWidth() const { return width; }
+    size_t windows() const { return used; }
+    double total(size_t window) const { return totals[window]; }
+    int peak(size_t window) const { return peaks[window]; }
+
+    // Merges neighbouring windows, doubling the window width.
+    void coarsen() {
+        size_t half = totals.size() / 2;
+        for (size_t i = 0; i < half; ++i) {
+            totals[i] = totals[2 * i] + totals[2 * i + 1];
+            peaks[i] = std::max(peaks[2 * i], peaks[2 * i + 1]);
+        }
+        std::fill(totals.begin() + half, totals.end(), 0.0);
+        std::fill(peaks.begin() + half, peaks.end(), 0);
+        width *= 2;
+        used = (used + 1) / 2;
+    }
+
+private:
+    size_t windowOf(int time) {
+        time = std::max(time, 0);
+        while (time / width >= static_cast<long long>(totals.size())) {
+            coarsen();
+        }
+        size_t window = static_cast<size_t>(time / width);
+        used = std::max(used, window + 1);
+        return window;
+    }
+
+    int width;
+    std::vector<double> totals;
+    std::vector<int> peaks;
+    size_t used = 0;
+};
+
+// Streaming summary of a run: latency histograms over the completed
+// processes, completions per time window and the ready-queue length over
+// time. Takes the same memory for ten processes or ten million.
+class SimulationStatistics {
+public:
+    explicit SimulationStatistics(int windowWidth = 100)
+        : throughput(windowWidth), readyQueue(windowWidth) {}
+
+    void readied(int time) {
+        // I/O completions and arrivals can be noticed after they happened;
+        // credit the queue with the time the process was already ready
+        if (time < lastChange) {
+            readyQueue.addSpan(time, lastChange, 1.0);
+        }
+        advance(time);
+        readyLength++;
+        readyQueue.observePeak(lastChange, readyLength);
+        alignWindows();
+    }
+
+    void dispatched(int time) {
+        advance(time);
+        readyLength--;
+    }
+
+    void completed(const Process& process, int time) {
+        waitingTimes.record(process.waitingTime);
+        responseTimes.record(process.responseTime);
+        turnaroundTimes.record(process.turnaroundTime);
+        longestWaits.record(process.longestWait);
+        throughput.add(time, 1.0);
+        alignWindows();
+    }
+
+    void finished(int time) {
+        advance(time);
+        endTime = std::max(endTime, time);
+    }
+
+    int readyQueueLength() const { return readyLength; }
+    const LatencyHistogram& waiting() const { return waitingTimes; }
+    const LatencyHistogram& response() const { return responseTimes; }
+    const LatencyHistogram& turnaround() const { return turnaroundTimes; }
+    const LatencyHistogram& longestWait() const { return longestWaits; }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"processes\": " << waitingTimes.count() << ",\n  \"simulationTime\": " << endTime << ",\n";
+        writeJsonHistogram(out, "waiting", waitingTimes);
+        writeJsonHistogram(out, "response", responseTimes);
+        writeJsonHistogram(out, "turnaround", turnaroundTimes);
+        writeJsonHistogram(out, "longestWait", longestWaits);
+        size_t windows = seriesLength();
+        out << "  \"windowWidth\": " << throughput.windowWidth() << ",\n  \"completions\": [";
+        for (size_t i = 0; i < windows; ++i) {
+            out << (i ? ", " : "") << static_cast<long long>(throughput.total(i));
+        }
+        out << "],\n  \"readyQueueMean\": [";
+        for (size_t i = 0; i < windows; ++i) {
+            out << (i ? ", " : "") << formatNumber(readyQueue.total(i) / readyQueue.windowWidth());
+        }
+        out << "],\n  \"readyQueueMax\": [";
+        for (size_t i = 0; i < windows; ++i) {
+            out << (i ? ", " : "") << readyQueue.peak(i);
+        }
+        out << "]\n}\n";
+    }
+
+    // Two tables separated by a blank line: one row per metric, then one row per time window.
+    void writeCsv(std::ostream& out) const {
+        out << "metric,count,min,mean,p50,p90,p99,p999,max\n";
+        writeCsvHistogram(out, "waiting", waitingTimes);
+        writeCsvHistogram(out, "response", responseTimes);
+        writeCsvHistogram(out, "turnaround", turnaroundTimes);
+        writeCsvHistogram(out, "longestWait", longestWaits);
+        out << "\nwindowStart,completions,readyQueueMean,readyQueueMax\n";
+        for (size_t i = 0, windows = seriesLength(); i < windows; ++i) {
+            out << static_cast<long long>(i) * throughput.windowWidth() << ","
+                << static_cast<long long>(throughput.total(i)) << ","
+                << formatNumber(readyQueue.total(i) / readyQueue.windowWidth()) << "," << readyQueue.peak(i) << "\n";
+        }
+    }
+
+private:
+    void advance(int time) {
+        if (time > lastChange) {
+            readyQueue.addSpan(lastChange, time, readyLength);
+            lastChange = time;
+            alignWindows();
+        }
+    }
+
+    // Keeps both series on the same windows so they tabulate side by side
+    void alignWindows() {
+        while (throughput.windowWidth() < readyQueue.windowWidth()) {
+            throughput.coarsen();
+        }
+        while (readyQueue.windowWidth() < throughput.windowWidth()) {
+            readyQueue.coarsen();
+        }
+    }
+
+    size_t seriesLength() const {
+        return std::max(throughput.windows(), readyQueue.windows());
+    }
+
+    static std::string formatNumber(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", value);
+        return text;
+    }
+
+    static void writeJsonHistogram(std::ostream& out, const char* name, const LatencyHistogram& histogram) {
+        out << "  \"" << name << "\": {\"count\": " << histogram.count() << ", \"min\": " << histogram.min()
+            << ", \"mean\": " << formatNumber(histogram.mean()) << ", \"p50\": " << histogram.percentile(50)
+            << ", \"p90\": " << histogram.percentile(90) << ", \"p99\": " << histogram.percentile(99)
+            << ", \"p999\": " << histogram.percentile(99.9) << ", \"max\": " << histogram.max() << "},\n";
+    }
+
+    static void writeCsvHistogram(std::ostream& out, const char* name, const LatencyHistogram& histogram) {
+        out << name << "," << histogram.count() << "," << histogram.min() << "," << formatNumber(histogram.mean())
+            << "," << histogram.percentile(50) << "," << histogram.percentile(90) << "," << histogram.percentile(99)
+            << "," << histogram.percentile(99.9) << "," << histogram.max() << "\n";
+    }
+
+    LatencyHistogram waitingTimes;
+    LatencyHistogram responseTimes;
+    LatencyHistogram turnaroundTimes;
+    LatencyHistogram longestWaits;
+    WindowedSeries throughput;
+    WindowedSeries readyQueue;
+    int readyLength = 0;
+    int lastChange = 0;
+    int endTime = 0;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Comparison.h"
+#include "Process.h"
+#include "Schedulers.h"
+#include "ThreadPool.h"
+#include "TraceSink.h"
+#include "Workloads.h"
+
+
+// Every combination of level count, first-level quantum and growth factor.
+// Quanta grow geometrically down the levels, and the last level is either
+// FCFS or round-robin with the next quantum in the sequence.
+inline std::vector<MlfqConfig> gridConfigs(const std::vector<int>& levelCounts, const std::vector<int>& baseQuanta,
+                                           const std::vector<int>& growthFactors) {
+    std::vector<MlfqConfig> configs;
+    for (int levels : levelCounts) {
+        for (int base : baseQuanta) {
+            for (int growth : growthFactors) {
+                for (bool fcfsBottom : { true, false }) {
+                    MlfqConfig config;
+                    config.quanta.clear();
+                    int quantum = base;
+                    for (int level = 0; level < levels; ++level) {
+                        config.quanta.push_back(quantum);
+                        quantum *= growth;
+                    }
+                    if (fcfsBottom) {
+                        config.quanta.back() = 0;
+                    }
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+// Random configurations with 1 to maxLevels levels and non-decreasing quanta.
+inline std::vector<MlfqConfig> randomConfigs(int count, int maxLevels, int maxQuantum, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> levelCount(1, maxLevels);
+    std::uniform_int_distribution<int> quantum(1, maxQuantum);
+    std::vector<MlfqConfig> configs;
+    for (int i = 0; i < count; ++i) {
+        MlfqConfig config;
+        config.quanta.resize(levelCount(rng));
+        for (int& value : config.quanta) {
+            value = quantum(rng);
+        }
+        std::sort(config.quanta.begin(), config.quanta.end());
+        if (rng() % 2 == 0) {
+            config.quanta.back() = 0;
+        }
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+inline std::string describe(const MlfqConfig& config) {
+    std::string text;
+    for (size_t i = 0; i < config.quanta.size(); ++i) {
+        if (i > 0) {
+            text += "/";
+        }
+        text += config.quanta[i] == 0 ? "FCFS" : std::to_string(config.quanta[i]);
+    }
+    return text;
+}
+
+// One configuration averaged over every workload in the sweep.
+struct SweepPoint {
+    MlfqConfig config;
+    double meanResponse = 0.0;   // Mean response time over all processes of all workloads
+    double throughput = 0.0;     // Completed processes per 1000 time units, averaged over workloads
+    bool paretoOptimal = false;
+    std::string error;
+};
+
+// Simulates every configuration against every workload, one task per pair.
+// Workloads are generated up front and cloned per task, so the only
+// allocations inside a simulation are its queues growing to their peak size.
+inline std::vector<SweepPoint> runSweep(const std::vector<MlfqConfig>& configs,
+                                        const std::vector<std::vector<Process>>& workloads, ThreadPool& pool) {
+    std::vector<ComparisonRow> runs(configs.size() * workloads.size());
+    for (size_t c = 0; c < configs.size(); ++c) {
+        for (size_t w = 0; w < workloads.size(); ++w) {
+            pool.submit([&configs, &workloads, &runs, c, w] {
+                ComparisonRow& run = runs[c * workloads.size() + w];
+                try {
+                    ClonedWorkload workload(workloads[w]);
+                    MetricsArrivalSource arrivals(workload, run);
+                    NullTraceSink discard;
+                    run.result = mlfqScheduler(arrivals, configs[c], discard);
+                }
+                catch (const std::exception& error) {
+                    run.error = error.what();
+                }
+            });
+        }
+    }
+    pool.wait();
+
+    std::vector<SweepPoint> points(configs.size());
+    for (size_t c = 0; c < configs.size(); ++c) {
+        SweepPoint& point = points[c];
+        point.config = configs[c];
+        long long completed = 0;
+        long long totalResponse = 0;
+        for (size_t w = 0; w < workloads.size(); ++w) {
+            const ComparisonRow& run = runs[c * workloads.size() + w];
+            if (!run.error.empty()) {
+                point.error = run.error;
+            }
+            completed += run.completed;
+            totalResponse += run.totalResponse;
+            if (run.result.totalSimulationTime > 0) {
+                point.throughput += 1000.0 * run.completed / run.result.totalSimulationTime;
+            }
+        }
+        point.meanResponse = completed > 0 ? static_cast<double>(totalResponse) / completed : 0.0;
+        point.throughput /= std::max<size_t>(1, workloads.size());
+    }
+    return points;
+}
+
+// Marks the points no other point beats on both lower mean response and
+// higher throughput.
+inline void markParetoFront(std::vector<SweepPoint>& points) {
+    std::vector<SweepPoint*> order;
+    for (SweepPoint& point : points) {
+        point.paretoOptimal = false;
+        if (point.error.empty()) {
+            order.push_back(&point);
+        }
+    }
+    std::sort(order.begin(), order.end(), [](const SweepPoint* a, const SweepPoint* b) {
+        if (a->meanResponse != b->meanResponse) {
+            return a->meanResponse < b->meanResponse;
+        }
+        return a->throughput > b->throughput;
+    });
+    double bestThroughput = -1.0;
+    for (SweepPoint* point : order) {
+        if (point->throughput > bestThroughput) {
+            point->paretoOptimal = true;
+            bestThroughput = point->throughput;
+        }
+    }
+}
+
+inline void printParetoFront(const std::vector<SweepPoint>& points, std::ostream& out) {
+    std::vector<const SweepPoint*> front;
+    for (const SweepPoint& point : points) {
+        if (point.paretoOptimal) {
+            front.push_back(&point);
+        }
+        else if (!point.error.empty()) {
+            out << describe(point.config) << ": " << point.error << "\n";
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const SweepPoint* a, const SweepPoint* b) {
+        return a->meanResponse < b->meanResponse;
+    });
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-32s %14s %14s\n", "Quanta", "Mean Resp", "Throughput");
+    out << line;
+    for (const SweepPoint* point : front) {
+        std::snprintf(line, sizeof(line), "%-32s %14.2f %14.3f\n",
+            describe(point->config).c_str(), point->meanResponse, point->throughput);
+        out << line;
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its
+// own tasks at the back, and when it runs dry it steals from the front of the
+// other workers' deques. Batches of uneven simulations therefore keep every
+// core busy until the last task, without all workers contending on one queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency()) {
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        for (unsigned i = 0; i < threadCount; ++i) {
+            queues.emplace_back(new WorkerQueue());
+        }
+        for (unsigned i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Tasks must not throw; wrap anything that can and record the error. A task
+    // submitted from one of this pool's workers goes onto that worker's deque.
+    void submit(std::function<void()> task) {
+        size_t target;
+        if (currentPool() == this) {
+            target = currentWorker();
+        }
+        else {
+            std::lock_guard<std::mutex> lock(mutex);
+            target = nextQueue++ % queues.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued++;
+            unfinished++;
+        }
+        taskAvailable.notify_one();
+    }
+
+    // Blocks until every submitted task has finished.
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this] { return unfinished == 0; });
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static ThreadPool*& currentPool() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentWorker() {
+        static thread_local size_t worker = 0;
+        return worker;
+    }
+
+    // Own deque first (newest task, still warm in cache), then the oldest task
+    // of each other worker in turn.
+    bool take(size_t self, std::function<void()>& task) {
+        {
+            WorkerQueue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            WorkerQueue& victim = *queues[(self + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        currentPool() = this;
+        currentWorker() = self;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskAvailable.wait(lock, [this] { return stopping || queued > 0; });
+                if (queued == 0) {
+                    return;
+                }
+            }
+            std::function<void()> task;
+            if (!take(self, task)) {
+                // Another worker got there between the wake-up and the take
+                std::this_thread::yield();
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queued--;
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--unfinished == 0) {
+                    allDone.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t nextQueue = 0;
+    size_t queued = 0;
+    size_t unfinished = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "ByteOrder.h"
+#include "MappedFile.h"
+#include "Process.h"
+#include "ProcessPool.h"
+
+
+// Workload trace files come in two forms, both ordered by arrival time.
+//
+// Text: one process per line, `pid arrival cpu io cpu io ... cpu`, where the
+// bursts alternate starting with CPU. Blank lines and lines starting with '#'
+// are ignored.
+//
+// Binary: the 8-byte magic "CPUTRACE", a uint32 version and a uint32 reserved
+// word, then one record per process: int32 pid, int32 arrival, uint32 cpu
+// count, uint32 I/O count, followed by the CPU bursts and the I/O times as
+// int32. All fields are little-endian (see ByteOrder.h).
+enum class TraceFormat { Text, Binary };
+
+static const char TraceMagic[8] = { 'C', 'P', 'U', 'T', 'R', 'A', 'C', 'E' };
+static const std::uint32_t TraceVersion = 1;
+
+// Streams processes out of a memory-mapped trace file. A record is only parsed
+// when the scheduler asks for the next arrival, into a Process from the
+// reader's pool that goes back to it once it retires, so memory stays bounded
+// by the number of live processes rather than the size of the trace, and a
+// long replay stops allocating once the pool has warmed up.
+class TraceReader : public ArrivalSource {
+public:
+    explicit TraceReader(const std::string& path,
+                         std::function<void(const Process&)> onRetire = nullptr)
+        : file(path), name(path), cursor(file.data()), end(file.data() + file.size()),
+          retired(std::move(onRetire)) {
+        if (file.size() >= sizeof(TraceMagic) && std::memcmp(cursor, TraceMagic, sizeof(TraceMagic)) == 0) {
+            format = TraceFormat::Binary;
+            cursor += sizeof(TraceMagic);
+            if (readWord() != TraceVersion) {
+                fail("unsupported binary trace version");
+            }
+            readWord();
+        }
+    }
+
+    TraceFormat traceFormat() const { return format; }
+
+    int nextArrivalTime() override {
+        if (pending == nullptr && !exhausted) {
+            pendingStart = cursor;
+            pendingLine = line;
+            pending = format == TraceFormat::Binary ? parseBinary() : parseText();
+            exhausted = pending == nullptr;
+            if (pending != nullptr) {
+                if (pending->initialArrivalTime < lastArrival) {
+                    fail("processes must be ordered by arrival time");
+                }
+                lastArrival = pending->initialArrivalTime;
+            }
+        }
+        return pending != nullptr ? pending->initialArrivalTime : INT_MAX;
+    }
+
+    Process* admit() override {
+        nextArrivalTime();
+        Process* process = pending;
+        pending = nullptr;
+        return process;
+    }
+
+    void retire(Process* process) override {
+        if (retired) {
+            retired(*process);
+        }
+        pool.release(process);
+    }
+
+    // Saves the offset of the first record not yet admitted.
+    void saveState(SnapshotWriter& out) const override {
+        out.writeSize(file.size());
+        out.writeSize(static_cast<std::uint64_t>((pending != nullptr ? pendingStart : cursor) - file.data()));
+        out.writeSize(pending != nullptr ? pendingLine : line);
+        out.writeInt(lastArrival);
+    }
+
+    void loadState(SnapshotReader& in) override {
+        std::uint64_t size = in.readSize();
+        std::uint64_t offset = in.readSize();
+        if (size != file.size() || offset > size) {
+            throw std::runtime_error(name + ": snapshot was taken on a different trace");
+        }
+        if (pending != nullptr) {
+            pool.release(pending);
+            pending = nullptr;
+        }
+        exhausted = false;
+        cursor = file.data() + offset;
+        line = static_cast<size_t>(in.readSize());
+        lastArrival = in.readInt();
+    }
+
+    Process* restoreProcess(Process saved) override { return pool.adopt(std::move(saved)); }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const {
+        if (format == TraceFormat::Text) {
+            throw std::runtime_error(name + ":" + std::to_string(line) + ": " + message);
+        }
+        throw std::runtime_error(name + ": " + message);
+    }
+
+    std::uint32_t readWord() {
+        if (end - cursor < 4) {
+            fail("truncated record");
+        }
+        std::uint32_t word = loadLittle32(cursor);
+        cursor += 4;
+        return word;
+    }
+
+    Process* parseBinary() {
+        if (cursor == end) {
+            return nullptr;
+        }
+        int pid = static_cast<int>(readWord());
+        int arrival = static_cast<int>(readWord());
+        std::uint32_t cpuCount = readWord();
+        std::uint32_t ioCount = readWord();
+        if (cpuCount == 0) {
+            fail("process " + std::to_string(pid) + " has no CPU bursts");
+        }
+        size_t cpuBytes = static_cast<size_t>(cpuCount) * 4;
+        size_t ioBytes = static_cast<size_t>(ioCount) * 4;
+        if (static_cast<size_t>(end - cursor) < cpuBytes + ioBytes) {
+            fail("truncated record");
+        }
+        Process* process = pool.acquire(pid);
+        process->cpuBursts.resize(cpuCount);
+        process->ioTimes.resize(ioCount);
+        for (std::uint32_t i = 0; i < cpuCount; ++i) {
+            process->cpuBursts[i] = static_cast<int>(loadLittle32(cursor + static_cast<size_t>(i) * 4));
+        }
+        cursor += cpuBytes;
+        for (std::uint32_t i = 0; i < ioCount; ++i) {
+            process->ioTimes[i] = static_cast<int>(loadLittle32(cursor + static_cast<size_t>(i) * 4));
+        }
+        cursor += ioBytes;
+        return checked(process, arrival);
+    }
+
+    Process* parseText() {
+        while (cursor < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            const char* position = cursor;
+            cursor = lineEnd < end ? lineEnd + 1 : end;
+            line++;
+
+            fields.clear();
+            int value = 0;
+            while (parseInt(position, lineEnd, value)) {
+                fields.push_back(value);
+            }
+            if (position != lineEnd && *position != '#') {
+                fail("unexpected character '" + std::string(1, *position) + "'");
+            }
+            if (fields.empty()) {
+                continue;
+            }
+            if (fields.size() < 3) {
+                fail("expected pid, arrival time and at least one CPU burst");
+            }
+            Process* process = pool.acquire(fields[0]);
+            for (size_t i = 2; i < fields.size(); ++i) {
+                ((i % 2 == 0) ? process->cpuBursts : process->ioTimes).push_back(fields[i]);
+            }
+            return checked(process, fields[1]);
+        }
+        return nullptr;
+    }
+
+    // Parses the next integer on the line, skipping leading blanks. Leaves
+    // `position` on the first character it could not consume.
+    bool parseInt(const char*& position, const char* lineEnd, int& value) {
+        while (position < lineEnd && (*position == ' ' || *position == '\t' || *position == '\r' || *position == ',')) {
+            ++position;
+        }
+        bool negative = position < lineEnd && *position == '-';
+        const char* digits = negative ? position + 1 : position;
+        if (digits >= lineEnd || *digits < '0' || *digits > '9') {
+            return false;
+        }
+        long long number = 0;
+        while (digits < lineEnd && *digits >= '0' && *digits <= '9') {
+            number = number * 10 + (*digits - '0');
+            if (number > INT_MAX) {
+                fail("number out of range");
+            }
+            ++digits;
+        }
+        value = static_cast<int>(negative ? -number : number);
+        position = digits;
+        return true;
+    }
+
+    // Validates a freshly parsed process, returning it to the pool if it is bad.
+    Process* checked(Process* process, int arrival) {
+        const char* problem = nullptr;
+        if (std::any_of(process->cpuBursts.begin(), process->cpuBursts.end(), [](int burst) { return burst <= 0; })) {
+            problem = " has a non-positive CPU burst";
+        }
+        else if (std::any_of(process->ioTimes.begin(), process->ioTimes.end(), [](int time) { return time < 0; })) {
+            problem = " has a negative I/O time";
+        }
+        else if (arrival < 0) {
+            problem = " has a negative arrival time";
+        }
+        else if (arrival == INT_MAX) {
+            problem = " arrives at INT_MAX, which the simulator reads as never";
+        }
+        if (problem != nullptr) {
+            int pid = process->pid;
+            pool.release(process);
+            fail("process " + std::to_string(pid) + problem);
+        }
+        process->initialArrivalTime = arrival;
+        process->arrivalTime = arrival;
+        return process;
+    }
+
+    MappedFile file;
+    std::string name;
+    const char* cursor;
+    const char* end;
+    TraceFormat format = TraceFormat::Text;
+    size_t line = 0;
+    int lastArrival = INT_MIN;
+    Process* pending = nullptr;
+    const char* pendingStart = nullptr;   // Where pending was parsed from
+    size_t pendingLine = 0;
+    bool exhausted = false;
+    std::function<void(const Process&)> retired;
+    ProcessPool pool;
+    std::vector<int> fields;   // Scratch for parseText, kept to reuse its capacity
+};
+
+// Writes processes to a trace file in either format. Processes must be
+// written in arrival order for the file to be readable.
+class TraceWriter {
+public:
+    TraceWriter(const std::string& path, TraceFormat format)
+        : output(path, std::ios::binary), name(path), format(format) {
+        if (!output) {
+            throw std::runtime_error("cannot create " + path);
+        }
+        if (format == TraceFormat::Binary) {
+            output.write(TraceMagic, sizeof(TraceMagic));
+            writeWord(TraceVersion);
+            writeWord(0);
+        }
+        else {
+            output << "# pid arrival cpu io cpu io ... cpu\n";
+        }
+    }
+
+    void write(const Process& process) {
+        if (format == TraceFormat::Binary) {
+            writeWord(static_cast<std::uint32_t>(process.pid));
+            writeWord(static_cast<std::uint32_t>(process.initialArrivalTime));
+            writeWord(static_cast<std::uint32_t>(process.cpuBursts.size()));
+            writeWord(static_cast<std::uint32_t>(process.ioTimes.size()));
+            for (int burst : process.cpuBursts) {
+                writeWord(static_cast<std::uint32_t>(burst));
+            }
+            for (int time : process.ioTimes) {
+                writeWord(static_cast<std::uint32_t>(time));
+            }
+            return;
+        }
+        if (process.ioTimes.size() > process.cpuBursts.size()) {
+            throw std::runtime_error("process " + std::to_string(process.pid)
+                + " has more I/O times than CPU bursts, which the text format cannot express");
+        }
+        output << process.pid << ' ' << process.initialArrivalTime;
+        size_t bursts = std::max(process.cpuBursts.size(), process.ioTimes.size());
+        for (size_t i = 0; i < bursts; ++i) {
+            if (i < process.cpuBursts.size()) {
+                output << ' ' << process.cpuBursts[i];
+            }
+            if (i < process.ioTimes.size()) {
+                output << ' ' << process.ioTimes[i];
+            }
+        }
+        output << '\n';
+    }
+
+    // Flushes the file, reporting any write that failed.
+    void finish() {
+        output.flush();
+        if (!output) {
+            throw std::runtime_error("failed writing " + name);
+        }
+    }
+
+private:
+    void writeWord(std::uint32_t word) {
+        char bytes[4];
+        storeLittle32(bytes, word);
+        output.write(bytes, sizeof(bytes));
+    }
+
+    std::ofstream output;
+    std::string name;
+    TraceFormat format;
+};
+
+// Re-encodes any readable trace in the requested format.
+inline void convertTrace(const std::string& inputPath, const std::string& outputPath, TraceFormat format) {
+    TraceReader reader(inputPath);
+    TraceWriter writer(outputPath, format);
+    while (reader.nextArrivalTime() != INT_MAX) {
+        Process* process = reader.admit();
+        writer.write(*process);
+        reader.retire(process);
+    }
+    writer.finish();
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ByteOrder.h"
+#include "MappedFile.h"
+
+
+// Everything a scheduler reports while it runs. The comment on each kind
+// says what `value` and `detail` hold.
+enum class TraceEventKind : std::uint32_t {
+    RunBurst,          // value: burst length
+    RunSlice,          // value: slice length, detail: queue level
+    BurstComplete,     //
+    IoStart,           // value: I/O time
+    Completed,         //
+    PreemptedBy,       // value: remaining CPU time, detail: preempting pid
+    PreemptedToLevel,  // detail: queue level the process returns to
+    Demoted,           // detail: new queue level
+    RunFinished,       // value: total CPU time, detail: total simulation time
+    SwitchIn,          // value: dispatch overhead before the process runs
+};
+
+// Fixed-size record appended by the simulation loop. Formatting happens
+// later, in whichever sink receives it, or never.
+struct TraceEvent {
+    std::int32_t time;
+    std::int32_t pid;
+    TraceEventKind kind;
+    std::int32_t value;
+    std::int32_t detail;
+};
+
+// Writes an event as the line the schedulers have always printed.
+inline void formatTraceEvent(const TraceEvent& event, std::ostream& out) {
+    if (event.kind == TraceEventKind::RunFinished) {
+        double cpuUtilization = (static_cast<double>(event.value) / event.detail) * 100.0;
+        out << "\nCPU Utilization: " << cpuUtilization << "%\n";
+        return;
+    }
+    out << "[Time " << event.time << "] Process P" << event.pid;
+    switch (event.kind) {
+        case TraceEventKind::RunBurst:
+            out << " is running CPU burst of " << event.value << " units.\n";
+            break;
+        case TraceEventKind::RunSlice:
+            out << " is running for " << event.value << " units (Queue Level " << event.detail << ").\n";
+            break;
+        case TraceEventKind::BurstComplete:
+            out << " has completed its CPU burst.\n";
+            break;
+        case TraceEventKind::IoStart:
+            out << " is performing I/O for " << event.value << " units.\n";
+            break;
+        case TraceEventKind::Completed:
+            out << " has completed execution.\n";
+            break;
+        case TraceEventKind::PreemptedBy:
+            out << " is preempted by P" << event.detail << " with " << event.value << " units left.\n";
+            break;
+        case TraceEventKind::PreemptedToLevel:
+            out << " is preempted and moved back to queue level " << event.detail << ".\n";
+            break;
+        case TraceEventKind::Demoted:
+            out << " is demoted to queue level " << event.detail << ".\n";
+            break;
+        case TraceEventKind::SwitchIn:
+            out << " is being switched in for " << event.value << " units.\n";
+            break;
+        default:
+            out << " (unknown event " << static_cast<std::uint32_t>(event.kind) << ")\n";
+            break;
+    }
+}
+
+// Receives the event stream of a scheduler run.
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+    virtual void record(const TraceEvent& event) = 0;
+
+    // Blocks until every recorded event has reached its destination.
+    virtual void flush() {}
+};
+
+// Drops every event. For sweeps and benchmarks that only want the results.
+class NullTraceSink : public TraceSink {
+public:
+    void record(const TraceEvent&) override {}
+};
+
+// Formats each event on the simulation thread, as the schedulers used to.
+class StreamTraceSink : public TraceSink {
+public:
+    explicit StreamTraceSink(std::ostream& out) : out(out) {}
+
+    void record(const TraceEvent& event) override { formatTraceEvent(event, out); }
+    void flush() override { out.flush(); }
+
+private:
+    std::ostream& out;
+};
+
+inline TraceSink& standardOutputTrace() {
+    static StreamTraceSink sink(std::cout);
+    return sink;
+}
+
+// Hands events to a background writer thread through a single-producer,
+// single-consumer lock-free ring. The simulation thread only copies a record
+// into the ring; the writer formats and writes. When the ring is full the
+// simulation waits for the writer rather than dropping events.
+//
+// A thread with nothing to do spins briefly, then parks on a condition
+// variable until the other side wakes it, so an idle sink costs no CPU.
+class AsyncTraceSink : public TraceSink {
+public:
+    explicit AsyncTraceSink(std::ostream& out, size_t capacity = 1 << 16)
+        : out(out), ring(roundUpToPowerOfTwo(capacity)), mask(ring.size() - 1),
+          writer([this] { drainLoop(); }) {}
+
+    ~AsyncTraceSink() override {
+        stopping.store(true);
+        wake(writerParked);
+        writer.join();
+        out.flush();
+    }
+
+    void record(const TraceEvent& event) override {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == ring.size()) {
+            park(producerParked, [this, tail] { return tail - head.load() < ring.size(); });
+        }
+        ring[tail & mask] = event;
+        this->tail.store(tail + 1);
+        wake(writerParked);
+    }
+
+    void flush() override {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        park(producerParked, [this, tail] { return head.load() == tail; });
+        std::lock_guard<std::mutex> lock(outputMutex);
+        out.flush();
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t capacity = 2;
+        while (capacity < value) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // Waits until `ready` holds: spins for a while, then sleeps with
+    // `parked` set until the other thread's wake() sees it. The flag and the
+    // head and tail are all sequentially consistent, so either the check
+    // after setting `parked` sees the other thread's progress or that thread
+    // sees `parked` and notifies.
+    template <typename Ready>
+    void park(std::atomic<bool>& parked, Ready ready) {
+        for (int spin = 0; spin < SpinsBeforeParking; ++spin) {
+            if (ready()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(parkMutex);
+        parked.store(true);
+        wakeup.wait(lock, ready);
+        parked.store(false);
+    }
+
+    // Called after publishing progress; wakes the other thread if it parked.
+    void wake(std::atomic<bool>& parked) {
+        if (parked.load()) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            wakeup.notify_all();
+        }
+    }
+
+    void drainLoop() {
+        for (;;) {
+            size_t head = this->head.load(std::memory_order_relaxed);
+            size_t tail = this->tail.load(std::memory_order_acquire);
+            if (head == tail) {
+                if (stopping.load(std::memory_order_acquire)
+                    && this->tail.load(std::memory_order_acquire) == head) {
+                    return;
+                }
+                park(writerParked, [this, head] { return this->tail.load() != head || stopping.load(); });
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                for (; head != tail; ++head) {
+                    formatTraceEvent(ring[head & mask], out);
+                }
+            }
+            this->head.store(head);
+            wake(producerParked);
+        }
+    }
+
+    static const int SpinsBeforeParking = 64;
+
+    std::ostream& out;
+    std::vector<TraceEvent> ring;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> writerParked{ false };
+    std::atomic<bool> producerParked{ false };
+    std::mutex parkMutex;
+    std::condition_variable wakeup;
+    std::mutex outputMutex;
+    std::thread writer;
+};
+
+// Compact binary event log: the 8-byte magic "CPUEVENT", a uint32 version and
+// a uint32 record size, then one record per event holding its time, pid,
+// kind, value and detail as 32-bit integers. All fields are little-endian
+// (see ByteOrder.h). printEventLog() turns a log back into the usual text.
+static const char EventLogMagic[8] = { 'C', 'P', 'U', 'E', 'V', 'E', 'N', 'T' };
+static const std::uint32_t EventLogVersion = 1;
+static const size_t EventRecordSize = 20;
+
+class BinaryTraceSink : public TraceSink {
+public:
+    explicit BinaryTraceSink(const std::string& path, size_t bufferedEvents = 4096)
+        : file(std::fopen(path.c_str(), "wb")), path(path) {
+        if (file == nullptr) {
+            throw std::runtime_error("cannot create " + path);
+        }
+        buffer.resize(std::max<size_t>(bufferedEvents, 1) * EventRecordSize);
+        char header[8];
+        storeLittle32(header, EventLogVersion);
+        storeLittle32(header + 4, static_cast<std::uint32_t>(EventRecordSize));
+        if (std::fwrite(EventLogMagic, 1, sizeof(EventLogMagic), file) != sizeof(EventLogMagic)
+            || std::fwrite(header, sizeof(header), 1, file) != 1) {
+            std::fclose(file);
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+
+    // A destructor cannot report a failed write; call flush() to find out.
+    ~BinaryTraceSink() override {
+        if (file != nullptr) {
+            if (used > 0) {
+                std::fwrite(buffer.data(), 1, used, file);
+            }
+            std::fclose(file);
+        }
+    }
+
+    void record(const TraceEvent& event) override {
+        char* record = buffer.data() + used;
+        storeLittle32(record, static_cast<std::uint32_t>(event.time));
+        storeLittle32(record + 4, static_cast<std::uint32_t>(event.pid));
+        storeLittle32(record + 8, static_cast<std::uint32_t>(event.kind));
+        storeLittle32(record + 12, static_cast<std::uint32_t>(event.value));
+        storeLittle32(record + 16, static_cast<std::uint32_t>(event.detail));
+        used += EventRecordSize;
+        if (used == buffer.size()) {
+            writeBuffer();
+        }
+    }
+
+    // Writes out the buffered records and closes the log, so a full disk or
+    // an I/O error surfaces here instead of as a truncated file. Recording
+    // more events reopens it for appending.
+    void flush() override {
+        if (file == nullptr) {
+            return;
+        }
+        writeBuffer();
+        int closed = std::fclose(file);
+        file = nullptr;
+        if (closed != 0) {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+
+private:
+    void writeBuffer() {
+        if (used == 0) {
+            return;
+        }
+        if (file == nullptr) {
+            file = std::fopen(path.c_str(), "ab");
+        }
+        if (file == nullptr || std::fwrite(buffer.data(), 1, used, file) != used) {
+            throw std::runtime_error("cannot write " + path);
+        }
+        used = 0;
+    }
+
+    std::FILE* file;
+    std::string path;
+    std::vector<char> buffer;   // Encoded records, the first `used` bytes filled
+    size_t used = 0;
+};
+
+// Offline pretty-printer for logs written by BinaryTraceSink.
+inline void printEventLog(const std::string& path, std::ostream& out) {
+    MappedFile file(path);
+    const size_t headerSize = sizeof(EventLogMagic) + 2 * sizeof(std::uint32_t);
+    if (file.size() < headerSize || std::memcmp(file.data(), EventLogMagic, sizeof(EventLogMagic)) != 0) {
+        throw std::runtime_error(path + ": not an event log");
+    }
+    const char* header = file.data() + sizeof(EventLogMagic);
+    if (loadLittle32(header) != EventLogVersion || loadLittle32(header + 4) != EventRecordSize) {
+        throw std::runtime_error(path + ": unsupported event log version");
+    }
+    const char* cursor = file.data() + headerSize;
+    const char* end = file.data() + file.size();
+    for (; static_cast<size_t>(end - cursor) >= EventRecordSize; cursor += EventRecordSize) {
+        TraceEvent event;
+        event.time = static_cast<std::int32_t>(loadLittle32(cursor));
+        event.pid = static_cast<std::int32_t>(loadLittle32(cursor + 4));
+        event.kind = static_cast<TraceEventKind>(loadLittle32(cursor + 8));
+        event.value = static_cast<std::int32_t>(loadLittle32(cursor + 12));
+        event.detail = static_cast<std::int32_t>(loadLittle32(cursor + 16));
+        formatTraceEvent(event, out);
+    }
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ArrivalSource.h"
+#include "Process.h"
+#include "ProcessPool.h"
+
+
+enum class BurstDistribution {
+    Exponential,
+    Pareto,       // Heavy-tailed: mostly short bursts with rare very long ones
+};
+
+// Parameters for a synthetic workload. Burst lengths and I/O times follow the
+// chosen distribution around the given means; gaps between arrivals are
+// exponentially distributed.
+struct WorkloadSpec {
+    int processes = 64;
+    int maxBursts = 10;              // CPU bursts per process, uniform in [1, maxBursts]
+    double meanCpuBurst = 8.0;
+    double meanIoTime = 30.0;
+    double meanInterarrival = 4.0;   // 0 makes every process arrive at time 0
+    BurstDistribution distribution = BurstDistribution::Exponential;
+    double paretoShape = 1.5;        // Tail index, > 1; smaller is heavier-tailed
+    double cpuBoundFraction = 0.0;   // Share of processes with 4x the CPU burst and 1/4 the I/O time
+};
+
+// Expected CPU time one process of the spec asks for.
+inline double meanCpuDemand(const WorkloadSpec& spec) {
+    double mix = 1.0 + 3.0 * spec.cpuBoundFraction;
+    return (1 + std::max(1, spec.maxBursts)) / 2.0 * spec.meanCpuBurst * mix;
+}
+
+// Draws the processes of a spec one at a time, in arrival order.
+class WorkloadGenerator {
+public:
+    WorkloadGenerator(const WorkloadSpec& spec, std::uint64_t seed)
+        : spec(spec), rng(seed), burstCount(1, std::max(1, spec.maxBursts)) {}
+
+    bool done() const { return generated == spec.processes; }
+    int nextArrivalTime() const {
+        // Long interarrival gaps over many processes can outrun the int clock
+        if (arrival >= INT_MAX) {
+            throw std::overflow_error("generated arrivals pass the 32-bit time range");
+        }
+        return static_cast<int>(arrival);
+    }
+
+    Process next() {
+        Process process(0, {}, {});
+        next(process);
+        return process;
+    }
+
+    // Draws the next process into an existing one, reusing its burst vectors.
+    void next(Process& process) {
+        bool cpuBound = spec.cpuBoundFraction > 0.0 && std::uniform_real_distribution<double>()(rng) < spec.cpuBoundFraction;
+        double cpuMean = cpuBound ? spec.meanCpuBurst * 4.0 : spec.meanCpuBurst;
+        double ioMean = cpuBound ? spec.meanIoTime / 4.0 : spec.meanIoTime;
+
+        int bursts = burstCount(rng);
+        process.cpuBursts.clear();
+        process.ioTimes.clear();
+        process.cpuBursts.reserve(bursts);
+        process.ioTimes.reserve(bursts - 1);
+        for (int k = 0; k < bursts; ++k) {
+            process.cpuBursts.push_back(draw(cpuMean));
+            if (k + 1 < bursts) {
+                process.ioTimes.push_back(draw(ioMean));
+            }
+        }
+        process.pid = ++generated;
+        process.initialArrivalTime = nextArrivalTime();
+        if (spec.meanInterarrival > 0.0) {
+            arrival += std::exponential_distribution<double>(1.0 / spec.meanInterarrival)(rng);
+        }
+    }
+
+    // The generator's position in its sequence, for checkpoints
+    void saveState(SnapshotWriter& out) const {
+        std::ostringstream engine;
+        engine << rng;
+        out.writeString(engine.str());
+        std::int64_t arrivalBits;
+        std::memcpy(&arrivalBits, &arrival, sizeof(arrival));
+        out.writeLong(arrivalBits);
+        out.writeInt(generated);
+    }
+
+    void loadState(SnapshotReader& in) {
+        std::istringstream engine(in.readString());
+        engine >> rng;
+        if (!engine) {
+            throw std::runtime_error("snapshot holds a corrupt workload generator");
+        }
+        std::int64_t arrivalBits = in.readLong();
+        std::memcpy(&arrival, &arrivalBits, sizeof(arrival));
+        generated = in.readInt();
+    }
+
+private:
+    // A whole number of time units, at least one and capped well inside int range
+    int draw(double mean) {
+        double value;
+        if (spec.distribution == BurstDistribution::Pareto) {
+            double scale = mean * (spec.paretoShape - 1.0) / spec.paretoShape;
+            value = scale / std::pow(1.0 - std::uniform_real_distribution<double>()(rng), 1.0 / spec.paretoShape);
+        }
+        else {
+            value = std::exponential_distribution<double>(1.0 / mean)(rng);
+        }
+        return std::max(1, static_cast<int>(std::lround(std::min(value, 1e6))));
+    }
+
+    WorkloadSpec spec;
+    std::mt19937_64 rng;
+    std::uniform_int_distribution<int> burstCount;
+    double arrival = 0.0;
+    int generated = 0;
+};
+
+// Builds the same workload for the same spec and seed on a given standard library.
+inline std::vector<Process> generateWorkload(const WorkloadSpec& spec, std::uint64_t seed) {
+    WorkloadGenerator generator(spec, seed);
+    std::vector<Process> processes;
+    processes.reserve(spec.processes);
+    while (!generator.done()) {
+        processes.push_back(generator.next());
+    }
+    return processes;
+}
+
+// The eight processes CPUScheduling runs when it is given no trace, all
+// arriving at time 0.
+inline std::vector<Process> builtInWorkload() {
+    return {
+        Process(1, { 5, 3, 5, 4, 6, 4, 3, 4 }, { 27, 31, 43, 18, 22, 26, 24 }),
+        Process(2, { 4, 5, 7, 12, 9, 4, 9, 7, 8 }, { 48, 44, 42, 37, 76, 41, 31, 43 }),
+        Process(3, { 8, 12, 18, 14, 4, 15, 14, 5, 6 }, { 33, 41, 65, 21, 61, 18, 26, 31 }),
+        Process(4, { 3, 4, 5, 3, 4, 5, 6, 5, 3 }, { 35, 41, 45, 51, 61, 54, 82, 77 }),
+        Process(5, { 16, 17, 5, 16, 7, 13, 11, 6, 3, 4 }, { 24, 21, 36, 26, 31, 28, 21, 13, 11 }),
+        Process(6, { 11, 4, 5, 6, 7, 9, 12, 15, 8 }, { 22, 8, 10, 12, 14, 18, 24, 30 }),
+        Process(7, { 14, 17, 11, 15, 4, 7, 16, 10 }, { 46, 41, 42, 21, 32, 19, 33 }),
+        Process(8, { 4, 5, 6, 14, 16, 6 }, { 14, 33, 51, 73, 87 }),
+    };
+}
+
+// Arrival source that draws each process only when it arrives, into a pooled
+// Process that is recycled when it retires, so a run holds just the live
+// processes in memory and stops allocating once the pool is warm. Admits
+// the same processes as generateWorkload() for the same spec and seed.
+class GeneratedArrivalSource : public ArrivalSource {
+public:
+    GeneratedArrivalSource(const WorkloadSpec& spec, std::uint64_t seed) : generator(spec, seed) {}
+
+    int nextArrivalTime() override { return generator.done() ? INT_MAX : generator.nextArrivalTime(); }
+
+    Process* admit() override {
+        Process* process = pool.acquire(0);
+        generator.next(*process);
+        return process;
+    }
+
+    void retire(Process* process) override { pool.release(process); }
+
+    void saveState(SnapshotWriter& out) const override { generator.saveState(out); }
+    void loadState(SnapshotReader& in) override { generator.loadState(in); }
+    Process* restoreProcess(Process saved) override { return pool.adopt(std::move(saved)); }
+
+private:
+    WorkloadGenerator generator;
+    ProcessPool pool;
+};